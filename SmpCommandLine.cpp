@@ -0,0 +1,7 @@
+// SmpCommandLine.cpp
+// The out-of-line members of SmpCommandLine.hpp, compiled once into the prebuilt library (the 
+// SMP_PREBUILT_LIBRARY option of CMakeLists.txt). Programs using that library are compiled with 
+// SMP_PREBUILT defined, so that the header only declares these members.
+
+#define SMP_IMPLEMENTATION
+#include "SmpCommandLine.hpp"
@@ -74,6 +74,16 @@
            getDouble( shortFlag, longFlag...), to extract a double number with specified flag
            getString( shortFlag, longFlag...), to extract a string with specified flag. 
            getBoolean( shortFlag, longFlag...), to extract a boolean with specified flag. 
+           getStringView( shortFlag, longFlag...), to extract a string as a std::string_view into
+                                                   argv, without copying it.
+           getInt64/getUInt64/getSize( shortFlag, longFlag...), to extract 64-bit integers, e.g. 
+                                                   large counts and byte offsets.
+           getIntegerList/getDoubleList/getStringList( shortFlag, longFlag, separator...), to 
+                                                   extract a list like '--ids 1,2,3' in one go.
+
+       Numbers are converted locale-free (std::from_chars) and the whole argument has to be a 
+       number: '12abc' or a value overflowing the requested type is reported and the default is 
+       used. Integers accept a '0x' (hex), '0o' (octal) or '0b' (binary) prefix.
 
     5) A special note to the getBoolean( shortFlag, longFlag,...) method: In this version, boolean 
        arguments are "flag-only" argument, which means that, in user command line, boolean arguments
@@ -105,6 +115,13 @@
        
        getString( 1, ... ) returns 'input_file.jpg', and
        getString( 2, ... ) returns 'output_file.jpg' 
+
+       To go through all unflagged arguments (e.g. a list of input files) in one pass, use:
+
+            for( std::string_view file : userCommands.positionals() ) { ... }
+            for( int n : userCommands.positionalsAs<int>() ) { ... }
+
+       or forEachPositionalChunk( chunkSize, callback ) to receive them in batches.
       
     7) Finally, if necessary, call below piece of codes to show help message to user, when it is 
        wanted:
@@ -116,6 +133,108 @@
        automatically composed from the helpMsg strings provided in the above calls to 
        getArgument(..., helpMsg ).
 
+    8) For programs that know their whole option set up front, the options may instead be declared
+       as a constexpr SmpOption table and wrapped in a SmpOptionSchema. Flags are then matched by
+       a perfect hash generated at compile time, see the "Compile-time option schema" section at 
+       the end of SmpCommandLine.hpp.
+
+    9) An argument '@path' in the command line is replaced by the arguments listed in the file 
+       'path' (a response file), for argument lists too long for the shell. Arguments in the file
+       are split as a POSIX shell splits them: white space separates, '...' and "..." quote, and a
+       backslash escapes the next character. Response files may be nested; the total size read is limited by 
+       SMP_RESPONSE_FILE_LIMIT, or by the constructor's third parameter (0 disables expansion).
+
+   10) For git-style tools with subcommands ('tool ingest ...', 'tool compact ...'), register a 
+       handler per subcommand in a SmpSubcommands and call its dispatch( argc, argv ): only the 
+       selected subcommand's SmpCommandLine is built, see the SmpSubcommands section below.
+
+   11) SmpCommandLine itself is not thread-safe, since every getXxxx() call consumes arguments. 
+       Once all arguments are extracted, call freeze() to get an immutable SmpParsedArgs: 
+            SmpParsedArgs args = userCommands.freeze();
+            int index = args.getInteger( "index" );      // or "i", "--index", "-i"
+       Any number of threads may then read the same SmpParsedArgs (or copies of it) without locks.
+       The same SmpParsedArgs can be handed to worker processes without parsing argv again:
+            int fd = args.writeSnapshot();                         // in the parent, before fork()
+            SmpParsedArgs args = SmpCommandLine::fromSnapshot( fd ); // in the child: mapped, not parsed
+
+   12) Options may also come from environment variables and a config file, with the precedence
+       command line > environment > config file > default:
+            userCommands.setEnvironmentPrefix( "MYAPP" );   // --radius is read from $MYAPP_RADIUS
+            userCommands.loadConfigFile( "myapp.ini" );     // 'radius = 2.5', '[db]' 'host = x' (--db.host)
+       Call both before the getters. The help message then shows where each value came from.
+
+   13) To parse many command lines in a row (e.g. control messages), reuse one parser:
+            parser.reset( argc, argv );
+       reset() keeps the capacity of the parser's tables, so once warm, it and the getters make no
+       heap allocation (getString() returns a std::string, use getStringView() instead). 
+       SmpSchemaArgs offers the same with reparse( argc, argv ).
+
+   14) A command line stored as one string (a job log line, a replay file, a control message) is
+       parsed with
+            SmpCommandLine command( "tool -xzvf --name 'hello world' in.txt" );
+       It is split into arguments like a POSIX shell does (the first word is the program name). 
+       The arguments are views into the string, so keep the string alive while using the parser.
+
+   15) Job manifests (one command line per line, millions of lines) are parsed against a 
+       SmpOptionSchema on all cores by SmpBatchParser, into one array per option, indexed by line;
+       see the "Batch parsing of job manifests" section at the end of SmpCommandLine.hpp.
+
+   16) Instead of one getter call per option, options may be bound to the fields of a struct once
+       and filled in a single pass over the command line:
+            SmpOptionBinder<Config> binder;
+            binder.bind( &Config::radius, "r", "radius", 6750.0, "the radius of the shpere" );
+            binder.parseInto( userCommands, config );
+       With parseInto(), the order rule of the IMPORTANT NOTES below does not apply. See the
+       SmpOptionBinder section below.
+
+   17) Options taking one of a fixed set of names ('--filter gaussian|box|median') are read as an 
+       enum with getChoice(), matched ignoring case through a compile-time perfect hash:
+            static constexpr SmpChoice<Filter> kFilterNames[] = { { "gaussian", kGaussian }, { "box", kBox } };
+            static constexpr SmpChoices kFilters( kFilterNames );
+            Filter filter = userCommands.getChoice( "f", "filter", kFilters, kGaussian, "image filter" );
+       The help message lists the choices.
+
+   18) After all getters, checkValidity() reports what is left over: unknown flags (with the 
+       closest registered flag as a 'did you mean --radius?' hint), flags missing their value, and
+       unflagged arguments beyond those extracted. It returns -1 if there is any problem; each one
+       is also kept as a SmpDiagnostic (kind, text, position, suggestion) in diagnostics():
+            if( userCommands.checkValidity() != 0 ) return( 1 );
+
+   19) Where output or exit() is unwanted (e.g. reparsing inside a service loop), use the 
+       try-getters, which print nothing and make no system call:
+            SmpResult<int> width = userCommands.tryGet<int>( "w", "width", 640, "width of image" );
+            int w = width.value_or( 640 );      // or: if( !width ) ... width.error() ...
+       SmpResult is std::expected<T, SmpDiagnostic> with C++23. Problems are collected in 
+       diagnostics(); checkValidity( false ) adds its own without printing, and showDiagnostics()
+       prints them all when wanted.
+
+   20) SmpCommandLine.hpp is header-only by default. In large builds, its members can instead be 
+       compiled once: with CMake, configure with -DSMP_PREBUILT_LIBRARY=ON and link the target 
+       SmpCommandLine as before. Without CMake, compile SmpCommandLine.cpp into a library and 
+       define SMP_PREBUILT in every program including the header (all of a program's translation
+       units have to agree).
+
+   21) For short-lived tools where process startup counts, define SMP_LOW_STARTUP before including
+       the header: messages go through a stack buffer and write(2) instead of stdio, and the 
+       parser's containers live in an inline arena of SMP_INLINE_STORAGE bytes (default 8192) inside
+       the SmpCommandLine object, so a typical command line is parsed without heap allocation. 
+       The parser is then neither copyable nor movable. SmpCommandLine_Startup.cpp measures both 
+       builds (CMake target run_startup_benchmark).
+
+   22) Sweeps over integers are given as one argument, 'start:stop[:step]' (stop excluded) or 
+       'first-last' (both included), and extracted as a lazy SmpRange, which computes each element
+       when it is read and never stores the sequence:
+            SmpRange<int64_t> frames = userCommands.getRange<int64_t>( "f", "frames", "0:100", "frames" );
+            for( int64_t frame : frames.partition( threadCount, threadIndex ) ) { ... }
+       partition() cuts the range into parts whose sizes differ by one at most.
+
+   23) Durations, byte sizes and counts are given with their units, and checked for overflow:
+            std::chrono::nanoseconds timeout = userCommands.getDuration( "t", "timeout", std::chrono::milliseconds( 250 ) );
+            uint64_t cache = userCommands.getBytes( "c", "cache", 4ull << 30 );   // '4GiB', '512M', '3GB'
+            uint64_t rate  = userCommands.getCount( "r", "rate", 10000 );         // '10k', '2.5M'
+       A duration needs its unit (ns, us, ms, s, min, h, d; e.g. '1.5s'). The help message shows 
+       the defaults in these units ('250ms', '4GiB', '10k'). The suffixes are listed in SmpUnits.
+
   # IMPORTANT NOTES: 
 
     1) Please make sure you call getXxxxx( shortFlag, longFlag, ... ) to extract ALL Flagged 
@@ -132,9 +251,18 @@
     * Flags should start with a alphabet ranging from 'a'~'z' or 'A'~'Z', please don't use number to 
 	  as start a flag.
     * string argument cannot contain any non-printable characters.
+    * SmpCommandLine requires a C++17 compiler (e.g. g++ -std=c++17).
+    * helpMsg strings are not copied, the help message is only composed when showHelpMessage() is
+      called. Please pass string literals (or strings that live as long as the SmpCommandLine).
+    * All internal storage of SmpCommandLine comes from a std::pmr::memory_resource. To place it in
+      an arena of your own (e.g. when parsing many short-lived command strings), construct with
+          SmpCommandLine command( argc, argv, &myMonotonicBufferResource );
 
   # Examples of Usage
    	Example codes could be found in SmpCommandLine_Demo.cpp
+   	Parse throughput (ns/token and heap allocations per phase, as CSV) can be measured with 
+   	SmpCommandLine_Benchmark.cpp, e.g. via the run_benchmark target of CMakeLists.txt.
+   	SmpCommandLine_Test.cpp checks the parser's behaviour; with CMake, run it by ctest.
 ###
 */
 
@@ -143,14 +271,76 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <iostream>
+#include <stdint.h>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <array>
 #include <algorithm> // for to_lower
 #include <cctype>
+#include <cstring>
+#include <cstdarg>
+#include <cassert>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <limits>
+#include <type_traits>
+
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <memory_resource>
+#include <iterator>
+#include <atomic>
+#include <thread>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// The try-getters return std::expected where the standard library has it (C++23).
+#if defined(__has_include)
+#if __has_include(<expected>) && __cplusplus > 202002L
+#include <expected>
+#endif
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SMP_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Header-only by default. SMP_PREBUILT: the heavier members are compiled once into a library 
+// instead of in every translation unit, see the end of this file.
+#if defined(SMP_IMPLEMENTATION)
+#define SMP_INLINE
+#else
+#define SMP_INLINE inline
+#endif
+
+// Upper limit of the total size of @response files expanded by one SmpCommandLine (0 disables the
+// expansion). Can also be given per SmpCommandLine, as the constructor's third parameter.
+#ifndef SMP_RESPONSE_FILE_LIMIT
+#define SMP_RESPONSE_FILE_LIMIT     ( 256u << 20 )
+#endif
+
+// SMP_LOW_STARTUP, for tiny helpers where process startup dominates: messages and help text are 
+// written with write(2) instead of stdio, and each SmpCommandLine keeps its tables in 
+// SMP_INLINE_STORAGE bytes of inline storage (the heap is used beyond that only), which makes it
+// non-copyable. Define it the same way in all translation units, and use it header-only.
+#if defined(SMP_LOW_STARTUP) && !defined(SMP_INLINE_STORAGE)
+#define SMP_INLINE_STORAGE          8192
+#endif
 
 // for debug:
-#ifndef DEBUG_MESSAGE 
+#if !defined(DEBUG_MESSAGE) && defined(SMP_LOW_STARTUP)
+#define _DEBUG_MESSAGE( x, ... )    smpPrintMessage( NULL, x, ##__VA_ARGS__ )
+#define _ERROR_MESSAGE( x, ... )    smpPrintMessage( "ERROR!: ", x, ##__VA_ARGS__ )
+#elif !defined(DEBUG_MESSAGE)
 #define _DEBUG_MESSAGE( x, ... )    printf( x, ##__VA_ARGS__ )
 #define _ERROR_MESSAGE( x, ... )    { printf( "ERROR!: "); printf( x, ##__VA_ARGS__ ); }
 #else   
@@ -158,637 +348,4955 @@
 #define _ERROR_MESSAGE ERROR_MESSAGE
 #endif
 
+// Writes help text and messages to stdout: with SMP_LOW_STARTUP straight through write(2), so 
+// that stdio buffers are never set up; otherwise through stdio, flushed at once.
+inline void smpWriteOutput( const char* data, size_t size )
+{
+#if defined(SMP_LOW_STARTUP) && defined(SMP_HAS_MMAP)
+    while( size > 0 ) 
+    {
+        ssize_t n = ::write( STDOUT_FILENO, data, size );
+        if( n < 0 && errno == EINTR )
+            continue;
+        if( n <= 0 )
+            break;
+        data += n;
+        size -= (size_t)n;
+    }
+#else
+    fwrite( data, 1, size, stdout );
+    fflush( stdout );
+#endif
+}
 
-class SmpCommandLine 
+// printf() of SMP_LOW_STARTUP (and of the version line in any build): formatted on the stack (longer
+// messages are cut) and written at once through smpWriteOutput().
+inline void smpPrintMessage( const char* prefix, const char* format, ... )
 {
-  private:
-    const std::string _VERSION_NUMBER_ = "SmpCommandLine V2.1.0, Dennis @ 2021-2025";
-  
-  protected:
-    const char kHyphenchar = '-';
-    const std::string kSingleHyphen = std::string("-");
-    const std::string kDoubleHyphen = std::string("--");
-    const std::string kEmptyString  = std::string("");
-    const std::string kSpaceString  = std::string(" ");
-    const bool        bQuitOnError  = false;
+    char text[1024];
+    size_t n = ( prefix != NULL ? strlen( prefix ) : 0 );
+    if( n > 0 )
+        memcpy( text, prefix, n );
 
-    std::vector<std::string> arguments;
-    std::vector<std::string> helpMessageQueue;
-    std::string firstLineFlagMsg;
+    va_list args;
+    va_start( args, format );
+    int length = vsnprintf( text + n, sizeof(text) - n, format, args );
+    va_end( args );
 
-    int  mArgCount;
-    int  maxUnflaggedArgs;
-    bool mbWarningHasShown;
-    bool mbHelpMsgHasShown;
-    bool mbUnflaggedApiCalled;
- 
-  // Below are Public Methods:
+    if( length > 0 )
+        n += std::min( (size_t)length, sizeof(text) - n - 1 );
+    smpWriteOutput( text, n );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Locale-free conversion of argument text to numbers. The whole text has to be a number: trailing
+// characters ('12abc') and values that overflow the target type are reported, together with the 
+// position where the conversion stopped. Integers may carry a sign and a '0x' (hexadecimal), '0o' 
+// (octal) or '0b' (binary) prefix; a leading '0' alone does not switch to octal.
+//-------------------------------------------------------------------------------------------------
+
+enum SmpConvertError { kSmpConvertOk = 0, kSmpConvertEmpty, kSmpConvertInvalid, kSmpConvertOutOfRange };
+
+struct SmpConvertResult {
+    SmpConvertError error;
+    size_t          position;  // offset in the text where the conversion failed
+};
+
+class SmpConvert 
+{
   public:
+    template< typename T >
+    static SmpConvertResult toNumber( std::string_view text, T& value )
+    {
+        if constexpr ( std::is_floating_point<T>::value ) 
+            return( toReal( text, value ) );
+        else 
+            return( toInteger( text, value ) );
+    };
 
-    SmpCommandLine( int argc, char *const argv[] )
+    template< typename T >
+    static SmpConvertResult toInteger( std::string_view text, T& value )
     {
-        mArgCount = argc;
+        static_assert( std::is_integral<T>::value && sizeof(T) <= sizeof(uint64_t), "unsupported integer type" );
 
-        for( int i = 0; i < mArgCount; i++ )
-        {
-            arguments.push_back( argv[i] );
+        if( text.empty() )
+            return( SmpConvertResult{ kSmpConvertEmpty, 0 } );
+
+        size_t pos = 0;
+        bool bNegative = false;
+        if( text[0] == '+' || text[0] == '-' ) {
+            bNegative = ( text[0] == '-' );
+            pos = 1;
         }
-        
-        // Split the combined single flags (e.g.: '-xzvf' expland to -x -z -v -f)
-        for( int i = 0; i < arguments.size(); i++ ) 
+
+        int base = 10;
+        if( text.size() > pos+2 && text[pos] == '0' ) 
         {
-            if( arguments[i][0] == kHyphenchar && arguments[i][1] != kHyphenchar &&
-               (arguments[i][1] >= 'a' && arguments[i][1] <= 'z' || 
-                arguments[i][1] >= 'A' && arguments[i][1] <= 'Z' ) &&
-                arguments[i].size() > 2 )
-            {
-                for( int j = 1; j < arguments[i].size(); j++ )
-                {
-                    if( (arguments[i][j] >= 'a' && arguments[i][j] <= 'z' || 
-                         arguments[i][j] >= 'A' && arguments[i][j] <= 'Z' ) ) 
-                    {
-                        std::string newflag = std::string("-")+arguments[i][j];
-                        arguments.insert( arguments.begin()+i, newflag );
-                        i++;
-                    } else {
+            char prefix = (char)( text[pos+1] | 0x20 );
+            base = ( prefix == 'x' ? 16 : prefix == 'o' ? 8 : prefix == 'b' ? 2 : 10 );
+            if( base != 10 )
+                pos += 2;
+        }
 
-                        std::string newflag = arguments[i].substr(j);
-                        arguments.insert( arguments.begin()+i, newflag );
-                        i++;
-                        break;
-                    }
-                }
-                arguments.erase( arguments.begin()+i );
-                i--;
+        uint64_t magnitude = 0;
+        const char* last = text.data() + text.size();
+        std::from_chars_result r = std::from_chars( text.data() + pos, last, magnitude, base );
+
+        if( r.ec == std::errc::invalid_argument )
+            return( SmpConvertResult{ kSmpConvertInvalid, pos } );
+        if( r.ec == std::errc::result_out_of_range )
+            return( SmpConvertResult{ kSmpConvertOutOfRange, pos } );
+        if( r.ptr != last )
+            return( SmpConvertResult{ kSmpConvertInvalid, size_t( r.ptr - text.data() ) } );
+
+        if( bNegative ) 
+        {
+            if( magnitude == 0 ) {
+                value = 0;
+            } else if( !std::is_signed<T>::value || magnitude - 1 > (uint64_t)std::numeric_limits<T>::max() ) {
+                return( SmpConvertResult{ kSmpConvertOutOfRange, 0 } );
+            } else {
+                value = T( -T( magnitude - 1 ) - 1 );
             }
+        } 
+        else 
+        {
+            if( magnitude > (uint64_t)std::numeric_limits<T>::max() )
+                return( SmpConvertResult{ kSmpConvertOutOfRange, 0 } );
+            value = T( magnitude );
         }
+        return( SmpConvertResult{ kSmpConvertOk, text.size() } );
+    };
+
+    template< typename T >
+    static SmpConvertResult toReal( std::string_view text, T& value )
+    {
+        // from_chars() takes no leading '+':
+        size_t pos = ( !text.empty() && text[0] == '+' ) ? 1 : 0;
+
+        if( text.size() == pos )
+            return( SmpConvertResult{ text.empty() ? kSmpConvertEmpty : kSmpConvertInvalid, pos } );
+        if( pos == 1 && text[1] == '-' )
+            return( SmpConvertResult{ kSmpConvertInvalid, pos } );
 
-        helpMessageQueue.push_back( std::string("Usage of ") + arguments[0] + ":");
-        helpMessageQueue.push_back( arguments[0] + " [argument1] ... [--flag1 arg] ..." );
+        const char* first = text.data() + pos;
+        const char* last = text.data() + text.size();
 
-        mbWarningHasShown = false;
-        mbHelpMsgHasShown = false;
-        mbUnflaggedApiCalled = false;
-        maxUnflaggedArgs = 0;
+#if defined(__cpp_lib_to_chars)
+        std::from_chars_result r = std::from_chars( first, last, value, std::chars_format::general );
+        const char* stop = r.ptr;
+        bool bOutOfRange = ( r.ec == std::errc::result_out_of_range );
+#else
+        // No floating point from_chars() in this standard library: strtod() on a local copy.
+        char buffer[128];
+        if( text.size() - pos >= sizeof(buffer) )
+            return( SmpConvertResult{ kSmpConvertInvalid, pos } );
+        memcpy( buffer, first, last - first );
+        buffer[ last - first ] = '\0';
 
-        // Bonus extension: show version info of SmpCommandLine(this module, not client software)
-        for( int i = 0; i < arguments.size(); i++ ) 
+        char* end = buffer;
+        errno = 0;
+        double number = strtod( buffer, &end );
+        const char* stop = first + ( end - buffer );
+        bool bOutOfRange = ( errno == ERANGE || number > std::numeric_limits<T>::max() || 
+                             number < -std::numeric_limits<T>::max() );
+        value = T( number );
+#endif
+        if( stop == first )
+            return( SmpConvertResult{ kSmpConvertInvalid, pos } );
+        if( bOutOfRange )
+            return( SmpConvertResult{ kSmpConvertOutOfRange, 0 } );
+        if( stop != last )
+            return( SmpConvertResult{ kSmpConvertInvalid, size_t( stop - text.data() ) } );
+
+        return( SmpConvertResult{ kSmpConvertOk, text.size() } );
+    };
+
+    static const char* errorString( SmpConvertError error )
+    {
+        switch( error ) 
         {
-            if( arguments[i] == "--SmpCommandLineVersion" ) {
-                showVersionInfo();
-                arguments.erase( arguments.begin()+i );
-                break;
-            }
+          case kSmpConvertOk:         return( "no error" );
+          case kSmpConvertEmpty:      return( "empty value" );
+          case kSmpConvertInvalid:    return( "invalid character" );
+          default:                    return( "value out of range" );
         }
+    };
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// A range of integers given as one argument, for sweeps ('--frames 0:10000000:4', '--seeds 1-1000'):
+//
+//     start:stop[:step]   'start' up to, but not including, 'stop' (down to it with a negative 
+//                         step); 'step' is 1 if not given, and must not be 0
+//     first-last          'first' to 'last', both included
+//     value               just 'value'
+//
+// Each number is converted by SmpConvert::toInteger() (sign, '0x' prefix, overflow checked); a 
+// 'stop' or 'last' that is not beyond the start makes an empty range. The range is a view: it 
+// holds the first element, the step and the element count, and computes an element when it is 
+// read, so the sequence is never stored. partition() cuts it into equal parts, e.g. per thread:
+//
+//     SmpRange<int64_t> frames = userCommands.getRange<int64_t>( "f", "frames", "0:100" );
+//     for( int64_t frame : frames.partition( threadCount, threadIndex ) ) { ... }
+//-------------------------------------------------------------------------------------------------
+
+template< typename T >
+class SmpRange 
+{
+    static_assert( std::is_integral<T>::value && !std::is_same<T, bool>::value && sizeof(T) <= sizeof(uint64_t), 
+                   "SmpRange<T>: T has to be an integer type" );
+  public:
+    class Iterator 
+    {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const T*;
+        using reference         = T;
+
+        constexpr Iterator( T start, int64_t step, uint64_t index ) : mStart( start ), mStep( step ), mIndex( index ) {};
 
-        ////
-        // Debug: show the final (splited) argument list:
-        //_DEBUG_MESSAGE( "List of argumanets:\n" );
-        //for( int i = 0; i < arguments.size(); i++ ) 
-        //{
-        //    _DEBUG_MESSAGE( "\t%s\n", arguments[i].c_str() );
-        //}
+        constexpr T operator*() const { return( T( (uint64_t)mStart + mIndex * (uint64_t)mStep ) ); };
+        constexpr Iterator& operator++() { mIndex++; return( *this ); };
+        constexpr Iterator operator++( int ) { Iterator it = *this; mIndex++; return( it ); };
+        constexpr bool operator==( const Iterator& other ) const { return( mIndex == other.mIndex ); };
+        constexpr bool operator!=( const Iterator& other ) const { return( mIndex != other.mIndex ); };
+
+      protected:
+        T        mStart;
+        int64_t  mStep;
+        uint64_t mIndex;
     };
 
-    // Extract flagged argument of int type
-    int getInteger( const char* shortFlag, const char* longFlag, int defaultValue = 0, const char* helpMsg = "" )
+    constexpr SmpRange() : mStart( 0 ), mStep( 1 ), mCount( 0 ) {};
+
+    constexpr SmpRange( T start, int64_t step, uint64_t count ) : mStart( start ), mStep( step ), mCount( count ) {};
+
+    constexpr Iterator begin() const { return( Iterator( mStart, mStep, 0 ) ); };
+    constexpr Iterator end() const   { return( Iterator( mStart, mStep, mCount ) ); };
+
+    constexpr uint64_t size() const { return( mCount ); };
+    constexpr bool empty() const    { return( mCount == 0 ); };
+    constexpr int64_t step() const  { return( mStep ); };
+
+    // Element 'i' (0 .. size()-1), computed; nothing is checked.
+    constexpr T operator[]( uint64_t i ) const { return( T( (uint64_t)mStart + i * (uint64_t)mStep ) ); };
+
+    constexpr T front() const { return( mStart ); };
+    constexpr T back() const  { return( (*this)[ mCount - 1 ] ); };
+
+    // Part 'part' (0 .. parts-1) of 'parts' consecutive parts, whose sizes differ by one at most
+    // (the first size() % parts parts are the longer ones). Out of these bounds, the empty range.
+    constexpr SmpRange partition( uint64_t parts, uint64_t part ) const
     {
-        addHelpMessage( shortFlag, longFlag, std::to_string(defaultValue), helpMsg );
+        if( part >= parts )
+            return( SmpRange( mStart, mStep, 0 ) );
 
-        std::string valueString = getFlaggedArgument( shortFlag, longFlag );
-    
-        if( !valueString.empty() ) 
+        uint64_t length = mCount / parts;
+        uint64_t longer = mCount % parts;
+        uint64_t first = part * length + std::min( part, longer );
+        return( SmpRange( (*this)[first], mStep, length + ( part < longer ? 1 : 0 ) ) );
+    };
+
+    // Converts 'text' in one of the forms above. 'range' is set only if the result is kSmpConvertOk;
+    // otherwise the result holds the position in 'text' where the conversion failed.
+    static SmpConvertResult parse( std::string_view text, SmpRange& range )
+    {
+        if( text.empty() )
+            return( SmpConvertResult{ kSmpConvertEmpty, 0 } );
+
+        T start = 0;
+        T stop = 0;
+        int64_t step = 1;
+        SmpConvertResult result;
+
+        size_t colon = text.find( ':' );
+        if( colon != std::string_view::npos ) 
         {
-            // TODO: check more format validity.
-            if( valueString[0]=='-' || valueString[0]=='+' || (valueString[0] >= '0' && valueString[0] <= '9') )
+            size_t colon2 = text.find( ':', colon + 1 );
+            if( ( result = convertPart( text, 0, colon, start ) ).error != kSmpConvertOk || 
+                ( result = convertPart( text, colon + 1, colon2, stop ) ).error != kSmpConvertOk )
+                return( result );
+
+            if( colon2 != std::string_view::npos ) 
             {
-                return( atoi( valueString.c_str() ) );
-            } else {
-                _ERROR_MESSAGE( "Invalid number following flag %s in command line.\n", 
-                                (shortFlag!=NULL? shortFlag:longFlag) );
-                if( bQuitOnError ) {
-                    exit(-1);
-                } else { 
-                    _DEBUG_MESSAGE( "Use default value.\n" );
-                    return( defaultValue );
-                }    
+                if( ( result = convertPart( text, colon2 + 1, text.size(), step ) ).error != kSmpConvertOk )
+                    return( result );
+                if( step == 0 )
+                    return( SmpConvertResult{ kSmpConvertInvalid, colon2 + 1 } );
             }
-        } else {
-            return( defaultValue );
+
+            uint64_t count = 0;
+            if( step > 0 && stop > start )
+                count = ( (uint64_t)stop - (uint64_t)start - 1 ) / (uint64_t)step + 1;
+            else if( step < 0 && stop < start )
+                count = ( (uint64_t)start - (uint64_t)stop - 1 ) / ( 0 - (uint64_t)step ) + 1;
+            range = SmpRange( start, step, count );
+            return( SmpConvertResult{ kSmpConvertOk, text.size() } );
         }
-    };
 
-    // Extract unflagged argument of int type
-    int getInteger( int index, int defaultValue = 0, const char* helpMsg = "" )
-    {   
-        addHelpMessage( index, std::to_string(defaultValue), helpMsg );
-        
-        std::string valueString = getUnflaggedArgument( index );
-       
-        if( !valueString.empty() ) 
+        // 'first-last': the '-' at the front is the sign of 'first'.
+        size_t dash = text.find( '-', 1 );
+        if( dash == std::string_view::npos ) 
         {
-            // TODO: check more format validity.
-            if( valueString[0]=='-' || valueString[0]=='+' || (valueString[0] >= '0' && valueString[0] <= '9') )
-            {
-                return( atoi( valueString.c_str() ) );
-            } else 
-            {
-                _ERROR_MESSAGE( "Invalid number at position %d in command line.\n", index );
-                if( bQuitOnError ) {
-                    exit(-1);
-                } else { 
-                    _DEBUG_MESSAGE( "Use default value.\n" );
-                    return( defaultValue );
-                }    
-            }
-        } else {
-            return( defaultValue );
+            if( ( result = convertPart( text, 0, text.size(), start ) ).error != kSmpConvertOk )
+                return( result );
+            range = SmpRange( start, 1, 1 );
+            return( SmpConvertResult{ kSmpConvertOk, text.size() } );
         }
-    };
 
-    // Extract flagged argument of flat type
-    float getFloat( const char* shortFlag, const char* longFlag, float defaultValue = 0.0, const char* helpMsg = "" )
-    {
-        addHelpMessage( shortFlag, longFlag, std::to_string(defaultValue), helpMsg );
-        
-        std::string valueString = getFlaggedArgument( shortFlag, longFlag );
-    
-        if( !valueString.empty() ) {
-            // TODO: check format validity.
-            if( valueString[0]=='.' || valueString[0]=='-' || valueString[0]=='+' ||
-               (valueString[0] >= '0' && valueString[0] <= '9') ) 
-            {
-                return( float(atof( valueString.c_str() )) );
-            } 
-            else 
-            {
-                _ERROR_MESSAGE( "Invalid number following flag %s in command line.\n", 
-                               (shortFlag!=NULL? shortFlag:longFlag) );
-                if( bQuitOnError ) {
-                    exit(-1);
-                } else { 
-                    _DEBUG_MESSAGE( "Use default value.\n" );
-                    return( defaultValue );
-                }    
-            }
-            
-        } else {
-            return( defaultValue );
+        if( ( result = convertPart( text, 0, dash, start ) ).error != kSmpConvertOk || 
+            ( result = convertPart( text, dash + 1, text.size(), stop ) ).error != kSmpConvertOk )
+            return( result );
+
+        uint64_t count = 0;
+        if( stop >= start ) 
+        {
+            count = (uint64_t)stop - (uint64_t)start + 1;
+            if( count == 0 )  // all 2^64 values of a 64-bit T
+                return( SmpConvertResult{ kSmpConvertOutOfRange, dash + 1 } );
         }
+        range = SmpRange( start, 1, count );
+        return( SmpConvertResult{ kSmpConvertOk, text.size() } );
     };
 
-    // Extract unflagged argument of flat type
-    float getFloat( int index, float defaultValue = 0.0, const char* helpMsg = "" )
+  protected:
+    // Converts text[first, last) (to the end if 'last' is npos), with the failure position in 'text'.
+    template< typename U >
+    static SmpConvertResult convertPart( std::string_view text, size_t first, size_t last, U& value )
     {
-        addHelpMessage( index, std::to_string(defaultValue), helpMsg );
-        
-        std::string valueString = getUnflaggedArgument( index );
-       
-        if( !valueString.empty() ) {
-            // TODO: check format validity.
-            if( valueString[0]=='.' || valueString[0]=='-' || valueString[0]=='+' ||
-               (valueString[0] >= '0' && valueString[0] <= '9') ) 
-            {
-                return( float(atof( valueString.c_str() )) );
-            } 
-            else 
-            {
-                _ERROR_MESSAGE( "Invalid number at position %d in command line.\n", index );
-                if( bQuitOnError ) {
-                    exit(-1);
-                } else { 
-                    _DEBUG_MESSAGE( "Use default value.\n" );
-                    return( defaultValue );
-                }    
-            }
-            
-        } else {
-            return( defaultValue );
-        }
+        std::string_view part = text.substr( first, last == std::string_view::npos ? std::string_view::npos : last - first );
+        SmpConvertResult result = SmpConvert::toInteger( part, value );
+        result.position += first;
+        return( result );
     };
 
-    // Extract flagged argument of double type
-    double getDouble( const char* shortFlag, const char* longFlag, double defaultValue = 0.0, const char* helpMsg = "" )
+    T        mStart;
+    int64_t  mStep;
+    uint64_t mCount;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Numbers with a unit suffix: durations ('250ms', '1.5s'), byte sizes ('4GiB', '512k') and counts 
+// ('10k', '2M'). The suffixes of each kind are a constexpr table of SmpUnit, ending with an entry
+// whose suffix is NULL. A number is a decimal, directly followed by one of the suffixes; its
+// fraction has to come to whole base units ('1.5KiB' is 1536 bytes, but '1.5B' is invalid), with
+// up to 9 significant fraction digits. The result is checked for overflow of 64 bits.
+//
+//     kDuration  ns, us (or µs), ms, s, min (or m), h, d; there is no default unit
+//     kBytes     B (or none); KiB, MiB, ... EiB and K, M, ... E (also 'k') are powers of 1024,
+//                KB, MB, ... EB (also 'kB') powers of 1000
+//     kCount     none; k (or K), M, G, T, P, E are powers of 1000, Ki, Mi, ... Ei of 1024
+//-------------------------------------------------------------------------------------------------
+
+struct SmpUnit {
+    const char* suffix;
+    uint64_t    scale;
+};
+
+class SmpUnits 
+{
+  public:
+    // In nanoseconds.
+    static constexpr SmpUnit kDuration[] = {
+        { "ns", 1ull }, { "us", 1000ull }, { "\xC2\xB5s", 1000ull }, { "ms", 1000000ull }, { "s", 1000000000ull }, 
+        { "min", 60000000000ull }, { "m", 60000000000ull }, { "h", 3600000000000ull }, { "d", 86400000000000ull }, 
+        { NULL, 0 } };
+
+    // Of the suffixes with the same scale, the first is the one shown by format().
+    static constexpr SmpUnit kBytes[] = {
+        { "B", 1ull }, { "", 1ull }, 
+        { "KiB", 1ull << 10 }, { "K", 1ull << 10 }, { "k", 1ull << 10 }, { "KB", 1000ull }, { "kB", 1000ull },
+        { "MiB", 1ull << 20 }, { "M", 1ull << 20 }, { "MB", 1000000ull },
+        { "GiB", 1ull << 30 }, { "G", 1ull << 30 }, { "GB", 1000000000ull },
+        { "TiB", 1ull << 40 }, { "T", 1ull << 40 }, { "TB", 1000000000000ull },
+        { "PiB", 1ull << 50 }, { "P", 1ull << 50 }, { "PB", 1000000000000000ull },
+        { "EiB", 1ull << 60 }, { "E", 1ull << 60 }, { "EB", 1000000000000000000ull },
+        { NULL, 0 } };
+
+    static constexpr SmpUnit kCount[] = {
+        { "", 1ull }, 
+        { "k", 1000ull }, { "K", 1000ull }, { "M", 1000000ull }, { "G", 1000000000ull }, { "T", 1000000000000ull },
+        { "P", 1000000000000000ull }, { "E", 1000000000000000000ull },
+        { "Ki", 1ull << 10 }, { "Mi", 1ull << 20 }, { "Gi", 1ull << 30 }, { "Ti", 1ull << 40 }, { "Pi", 1ull << 50 }, 
+        { "Ei", 1ull << 60 }, 
+        { NULL, 0 } };
+
+    // Converts 'text' with one of 'units'. 'value' is set only if the result is kSmpConvertOk; 
+    // otherwise the result holds the position in 'text' where the conversion failed.
+    static SmpConvertResult parse( std::string_view text, const SmpUnit* units, uint64_t& value )
     {
-        addHelpMessage( shortFlag, longFlag, std::to_string(defaultValue), helpMsg );
-        
-        std::string valueString = getFlaggedArgument( shortFlag, longFlag );
-    
-        if( !valueString.empty() ) {
-            // TODO: check format validity.
-            if( valueString[0]=='.' || valueString[0]=='-' || valueString[0]=='+' || 
-               (valueString[0] >= '0' && valueString[0] <= '9') ) 
-            {
-                return( atof( valueString.c_str() ) );
-            } 
-            else 
+        if( text.empty() )
+            return( SmpConvertResult{ kSmpConvertEmpty, 0 } );
+
+        const char* first = text.data();
+        const char* last = text.data() + text.size();
+        uint64_t whole = 0;
+        std::from_chars_result r = std::from_chars( first, last, whole );
+
+        if( r.ec == std::errc::result_out_of_range )
+            return( SmpConvertResult{ kSmpConvertOutOfRange, 0 } );
+        bool bDigits = ( r.ec == std::errc() );
+        size_t pos = ( bDigits ? r.ptr - first : 0 );
+
+        uint64_t fraction = 0;
+        uint64_t fractionScale = 1;
+        size_t point = pos;
+        bool bCutOff = false;  // a non-zero digit beyond the 9th
+        if( pos < text.size() && text[pos] == '.' ) 
+        {
+            for( pos++; pos < text.size() && text[pos] >= '0' && text[pos] <= '9'; pos++ ) 
             {
-                _ERROR_MESSAGE( "Invalid number following flag %s in command line.\n", 
-                               (shortFlag!=NULL? shortFlag:longFlag) );
-                if( bQuitOnError ) {
-                    exit(-1);
-                } else { 
-                    _DEBUG_MESSAGE("Use default value.\n");
-                    return( defaultValue );
-                }    
+                if( fractionScale < 1000000000ull ) {
+                    fraction = fraction * 10 + ( text[pos] - '0' );
+                    fractionScale *= 10;
+                } else {
+                    bCutOff = bCutOff || text[pos] != '0';
+                }
+                bDigits = true;
             }
-        } else {
-            return( defaultValue );
         }
+        if( !bDigits )
+            return( SmpConvertResult{ kSmpConvertInvalid, 0 } );
+
+        const SmpUnit* unit = find( text.substr( pos ), units );
+        if( unit == NULL )
+            return( SmpConvertResult{ kSmpConvertInvalid, pos } );
+
+        // whole * scale + fraction * scale / fractionScale, where scale = a * fractionScale + b; a 
+        // fraction that is no whole number of base units (e.g. '1.5B' or '0.5ns') is invalid:
+        uint64_t a = unit->scale / fractionScale;
+        uint64_t b = unit->scale % fractionScale;
+        if( bCutOff || fraction * b % fractionScale != 0 )
+            return( SmpConvertResult{ kSmpConvertInvalid, point } );
+        uint64_t part = fraction * a + fraction * b / fractionScale;
+        uint64_t kMax = std::numeric_limits<uint64_t>::max();
+        if( whole > kMax / unit->scale || whole * unit->scale > kMax - part )
+            return( SmpConvertResult{ kSmpConvertOutOfRange, 0 } );
+
+        value = whole * unit->scale + part;
+        return( SmpConvertResult{ kSmpConvertOk, text.size() } );
     };
 
-    // Extract unflagged argument of double type
-    double getDouble( int index, double defaultValue = 0.0, const char* helpMsg = "" )
+    // The unit of 'suffix', NULL if there is none.
+    static const SmpUnit* find( std::string_view suffix, const SmpUnit* units )
     {
-        addHelpMessage( index, std::to_string(defaultValue), helpMsg );
-        
-        std::string valueString = getUnflaggedArgument( index );
-    
-        if( !valueString.empty() ) {
-            // TODO: check format validity.
-            if( valueString[0]=='.' || valueString[0]=='-' || valueString[0]=='+' || 
-               (valueString[0] >= '0' && valueString[0] <= '9') ) 
-            {
-                return( atof( valueString.c_str() ) );
-            } 
-            else 
-            {
-                _ERROR_MESSAGE( "Invalid number at position %d in command line.\n", index );
-                if( bQuitOnError ) {
-                    exit(-1);
-                } else { 
-                    _DEBUG_MESSAGE("Use default value.\n");
-                    return( defaultValue );
-                }    
-            }
-        } else {
-            return( defaultValue );
+        for( ; units->suffix != NULL; units++ ) {
+            if( suffix == units->suffix )
+                return( units );
         }
+        return( NULL );
     };
 
-    // Extract flagged argument of bealean type
-    bool getBoolean( const char* shortFlag, const char* longFlag, const char* helpMsg = "" )
+    // Writes 'value' in the largest unit that divides it, e.g. "4GiB" or "250ms", into 'buffer'; 
+    // returns the length, as snprintf() does.
+    static int format( uint64_t value, const SmpUnit* units, char* buffer, size_t size )
     {
-        addHelpMessage( shortFlag, longFlag, bool2String(false), helpMsg, true ); // bIsBoolean == true
-
-        std::string valueString = getFlaggedArgument( shortFlag, longFlag, true ); // bIsBoolean == true
-    
-        if( !valueString.empty() ) {
-            return( true );
-        } else {  
-            return( false );
+        const SmpUnit* best = units;
+        for( const SmpUnit* unit = units; value != 0 && unit->suffix != NULL; unit++ ) {
+            if( unit->scale > best->scale && value % unit->scale == 0 )
+                best = unit;
         }
+        return( snprintf( buffer, size, "%llu%s", (unsigned long long)( value / best->scale ), best->suffix ) );
     };
 
+    // Writes the suffixes of 'units' as a list ("ns, us, ..."), cut off at 'size'.
+    static void list( const SmpUnit* units, char* buffer, size_t size )
+    {
+        size_t length = 0;
+        buffer[0] = '\0';
+        for( ; units->suffix != NULL && length < size; units++ ) {
+            if( units->suffix[0] != '\0' )
+                length += snprintf( buffer + length, size - length, "%s%s", ( length > 0 ? ", " : "" ), units->suffix );
+        }
+    };
+};
 
-    // Extract unflagged argument of boolean type
-    bool getBoolean( int index, bool defaultValue=false, const char* helpMsg = "" )
-    {   
-        addHelpMessage( index, bool2String(defaultValue), helpMsg );
 
-        std::string argString = getUnflaggedArgument( index );
-       
-        if( !argString.empty() ) 
-        {
-            int errorCode;
-            bool retValue = string2Bool( argString, defaultValue, &errorCode );
+//-------------------------------------------------------------------------------------------------
+// Delimiter scanning for list-valued arguments ('--ids 1,2,3') and shell-style splitting of command
+// strings. With SSE2 the text is compared 16 bytes at a time, otherwise byte by byte.
+//-------------------------------------------------------------------------------------------------
 
-            if( errorCode == 0 ) {
-                return( retValue );
-            } else {
-                _ERROR_MESSAGE( "Invalid argument for boolean type in command line (index=%d), return default value.\n", index );
-                return( defaultValue );
-            } 
+class SmpSplit 
+{
+  public:
+    // Number of occurrences of 'separator' in 'text'.
+    static size_t count( std::string_view text, char separator )
+    {
+        const char* data = text.data();
+        size_t size = text.size();
+        size_t i = 0;
+        size_t n = 0;
+#if defined(__SSE2__)
+        const __m128i pattern = _mm_set1_epi8( separator );
+        for( ; i + 16 <= size; i += 16 ) {
+            __m128i block = _mm_loadu_si128( (const __m128i*)( data + i ) );
+            n += __builtin_popcount( _mm_movemask_epi8( _mm_cmpeq_epi8( block, pattern ) ) );
         }
-        else 
-        {
-            return( defaultValue );
+#endif
+        for( ; i < size; i++ ) {
+            n += ( data[i] == separator );
         }
+        return( n );
     };
 
-    // Extract flagged argument of string type
-    std::string getString( const char* shortFlag, const char* longFlag, std::string defaultValue = "", const char* helpMsg = "" )
+    // Position of the first 'separator' at or after 'from', text.size() if there is none.
+    static size_t find( std::string_view text, size_t from, char separator )
     {
-        addHelpMessage( shortFlag, longFlag, defaultValue, helpMsg );
-        
-        std::string valueString = getFlaggedArgument( shortFlag, longFlag );
-    
-        if( !valueString.empty() && valueString != std::string(" ") ) 
-            return( valueString );
-        else 
-            return( defaultValue );
+        const char* data = text.data();
+        size_t size = text.size();
+        size_t i = from;
+#if defined(__SSE2__)
+        const __m128i pattern = _mm_set1_epi8( separator );
+        for( ; i + 16 <= size; i += 16 ) {
+            __m128i block = _mm_loadu_si128( (const __m128i*)( data + i ) );
+            int mask = _mm_movemask_epi8( _mm_cmpeq_epi8( block, pattern ) );
+            if( mask != 0 )
+                return( i + __builtin_ctz( mask ) );
+        }
+#endif
+        for( ; i < size; i++ ) {
+            if( data[i] == separator )
+                return( i );
+        }
+        return( size );
     };
 
-    // Extract unflagged argument of string type
-    std::string getString( int index, std::string defaultValue = "", const char* helpMsg = "" )
-    {   
-        addHelpMessage( index, defaultValue, helpMsg );
-        
-        std::string argString = getUnflaggedArgument( index );
-       
-        if( !argString.empty() ) 
-            return( argString );
-        else 
-            return( defaultValue );
+    // Position of the first white space, quote or backslash at or after 'from', text.size() if 
+    // there is none: the characters that end a shell word, or need unquoting within it.
+    static size_t findShellSpecial( std::string_view text, size_t from )
+    {
+        const char* data = text.data();
+        size_t size = text.size();
+        size_t i = from;
+#if defined(__SSE2__)
+        const __m128i space     = _mm_set1_epi8( ' ' );
+        const __m128i single    = _mm_set1_epi8( '\'' );
+        const __m128i dbl       = _mm_set1_epi8( '"' );
+        const __m128i backslash = _mm_set1_epi8( '\\' );
+        const __m128i tab       = _mm_set1_epi8( '\t' );
+        const __m128i four      = _mm_set1_epi8( 4 );
+        for( ; i + 16 <= size; i += 16 ) {
+            __m128i block = _mm_loadu_si128( (const __m128i*)( data + i ) );
+            // '\t' .. '\r' are 9 .. 13: (c - 9) <= 4 as unsigned bytes.
+            __m128i control = _mm_sub_epi8( block, tab );
+            __m128i hits = _mm_cmpeq_epi8( _mm_min_epu8( control, four ), control );
+            hits = _mm_or_si128( hits, _mm_cmpeq_epi8( block, space ) );
+            hits = _mm_or_si128( hits, _mm_cmpeq_epi8( block, single ) );
+            hits = _mm_or_si128( hits, _mm_cmpeq_epi8( block, dbl ) );
+            hits = _mm_or_si128( hits, _mm_cmpeq_epi8( block, backslash ) );
+            int mask = _mm_movemask_epi8( hits );
+            if( mask != 0 )
+                return( i + __builtin_ctz( mask ) );
+        }
+#endif
+        for( ; i < size; i++ ) {
+            char c = data[i];
+            if( isspace( (unsigned char)c ) || c == '\'' || c == '"' || c == '\\' )
+                return( i );
+        }
+        return( size );
     };
 
-    void showHelpMessage()
+    // Reads the next argument of a command string or response file starting at 'pos', split as a 
+    // POSIX shell does: white space separates arguments, '...' quotes literally, "..." quotes with 
+    // \\ \" \$ \` and \<newline> escapes, and a backslash outside quotes escapes any character 
+    // (\<newline> continues the line). Words without quotes or backslashes, the common case, are 
+    // found by one vectorized scan and returned as views into 'text'. Others are unquoted into 
+    // 'out', which needs room for the rest of the text (it may be 'text + pos' itself, to unquote in
+    // place); with 'out' NULL, kShellNeedsBuffer is returned for them,
+    // and 'pos' is left at the start of the word. A quote left open, or a backslash ending the 
+    // text, takes the rest of the text into the word: kShellUnterminated is returned for it, with
+    // 'arg' as far as it was unquoted, and the caller reports it rather than using it.
+    enum { kShellEnd = 0, kShellArgument, kShellNeedsBuffer, kShellUnterminated };
+
+    static int nextShellArgument( const char* text, size_t size, size_t& pos, char* out, std::string_view& arg )
     {
-        // Construct the first line of help message:
-        std::string firstLineMsg = arguments[0]+" ";
-        
-        for( int i = 0; i < maxUnflaggedArgs && i < 3; i++ )
+        // Skip white space, and line continuations between words:
+        while( pos < size ) 
         {
-            firstLineMsg += "[argument"+std::to_string(i+1)+"] ";
+            if( isspace( (unsigned char)text[pos] ) )
+                pos++;
+            else if( text[pos] == '\\' && pos + 1 < size && text[pos+1] == '\n' )
+                pos += 2;
+            else
+                break;
         }
+        if( pos >= size )
+            return( kShellEnd );
 
-        if( maxUnflaggedArgs > 3 ) {
-            firstLineMsg += "... ";
+        size_t start = pos;
+        size_t end = findShellSpecial( std::string_view( text, size ), start );
+
+        if( end >= size || isspace( (unsigned char)text[end] ) ) {
+            arg = std::string_view( text + start, end - start );
+            pos = end;
+            return( kShellArgument );
         }
-        firstLineMsg += firstLineFlagMsg;
-    
-        // Update:
-        helpMessageQueue[1] = firstLineMsg;
+        if( out == NULL )
+            return( kShellNeedsBuffer );
 
-        // Show them:
-        for( int i = 0; i < helpMessageQueue.size(); i++ )
+        // The plain head is moved as it is, the rest unquoted character by character:
+        memmove( out, text + start, end - start );
+        char* o = out + ( end - start );
+        char  quote = 0;
+
+        for( pos = end; pos < size; pos++ ) 
         {
-            if( i >= 2 ){
-                std::cout << "\t";
+            char c = text[pos];
+
+            if( quote == 0 ) 
+            {
+                if( isspace( (unsigned char)c ) ) {
+                    break;
+                } else if( c == '\'' || c == '"' ) {
+                    quote = c;
+                } else if( c == '\\' && pos + 1 < size ) {
+                    if( text[++pos] != '\n' ) 
+                        *o++ = text[pos];
+                } else if( c == '\\' ) {
+                    quote = c;  // the escape of nothing
+                } else {
+                    *o++ = c;
+                }
+            } 
+            else if( c == quote ) {
+                quote = 0;
+            } else if( quote == '"' && c == '\\' && pos + 1 < size && isDoubleQuoteEscape( text[pos+1] ) ) {
+                if( text[++pos] != '\n' ) 
+                    *o++ = text[pos];
+            } else {
+                *o++ = c;
             }
-            std::cout << helpMessageQueue[i] << std::endl;
         }
-
-        mbHelpMsgHasShown = true;
+        arg = std::string_view( out, o - out );
+        return( quote == 0 ? kShellArgument : kShellUnterminated );
     };
 
-    bool helpMessageWanted( int minArgc = -1 )
+    static bool isDoubleQuoteEscape( char c )
     {
-        // Handling help message trigers:
-        bool bHelpMsgWanted = getBoolean( "h", "help", "Show this help message" );
+        return( c == '\\' || c == '"' || c == '$' || c == '`' || c == '\n' );
+    };
+};
 
-        return( bHelpMsgWanted || (minArgc > 0 && mArgCount < minArgc) );
-    }
 
-    void showHelpMsgOnRequest()
-    {
-        // Handling help message trigers:
-        bool bHelpMsgRequested = getBoolean( "h", "help", "Show this help message" );
+//-------------------------------------------------------------------------------------------------
+// Levenshtein distance from one pattern (e.g. a mistyped flag) to many texts, with Myers'
+// bit-parallel algorithm: a column of the distance matrix is kept as bit vectors in one 64-bit
+// word, so every text character costs a handful of word operations. The pattern is limited to 64
+// characters; the character masks are built once, in the constructor.
+//-------------------------------------------------------------------------------------------------
 
-        if( bHelpMsgRequested && ! mbHelpMsgHasShown )
-            showHelpMessage();
-    }
+class SmpEditDistance
+{
+  public:
+    static constexpr size_t kMaxPatternLength = 64;
 
-    //  Check the validity of user inputed command line, according to the getArgument functions called
-    //  previously in code.
-    int checkValidity()
+    explicit SmpEditDistance( std::string_view pattern )
     {
-        if( arguments.size() > 1 )
-        {
-            for( int i = 1; i < arguments.size(); i++ )
-            {
-                if( arguments[i][0] == kHyphenchar ) {
-                    _ERROR_MESSAGE( "checkValidity(): Unknown flag %s detected in command line", arguments[i].c_str() );
-                    return(-1);
-                }
-            }
-        } 
-        _DEBUG_MESSAGE("checkValidity(): WARNING! Feature not completedly implemented.\n");
-        return(0);
+        memset( mPeq, 0, sizeof(mPeq) );
+        mLength = (int)pattern.size();
+        for( int i = 0; valid() && i < mLength; i++ ) {
+            mPeq[ (unsigned char)pattern[i] ] |= (uint64_t)1 << i;
+        }
     };
 
-    void showVersionInfo()
+    bool valid() const { return( mLength <= (int)kMaxPatternLength ); };
+
+    // Distance from the pattern to 'text', or 'limit'+1 if it is larger than 'limit'.
+    int distance( std::string_view text, int limit ) const
     {
-        std::cout << _VERSION_NUMBER_ << std::endl;
-    }
+        int n = (int)text.size();
+        if( !valid() || n - mLength > limit || mLength - n > limit )
+            return( limit + 1 );
+        if( mLength == 0 )
+            return( n );  // the length check above already bounds it by 'limit'
 
+        uint64_t highBit = (uint64_t)1 << ( mLength - 1 );
+        uint64_t pv = ~(uint64_t)0;
+        uint64_t mv = 0;
+        int score = mLength;
 
-  //-----------------------------------------------------------------------------------------------
-  // Below are private / protected Methods:
+        for( int j = 0; j < n; j++ )
+        {
+            uint64_t eq = mPeq[ (unsigned char)text[j] ];
+            uint64_t xv = eq | mv;
+            uint64_t xh = ( ( ( eq & pv ) + pv ) ^ pv ) | eq;
+            uint64_t ph = mv | ~( xh | pv );
+            uint64_t mh = pv & xh;
+
+            if( ph & highBit )
+                score++;
+            else if( mh & highBit )
+                score--;
+
+            // Row 0 of the matrix grows by one per text character, hence the carried-in 1:
+            ph = ( ph << 1 ) | 1;
+            mh = mh << 1;
+            pv = mh | ~( xv | ph );
+            mv = ph & xv;
+
+            // The distance can drop by at most one per remaining character:
+            if( score - ( n - 1 - j ) > limit )
+                return( limit + 1 );
+        }
+        return( score <= limit ? score : limit + 1 );
+    };
+
+  protected:
+    uint64_t mPeq[256];  // bit i set in mPeq[c]: pattern[i] == c
+    int      mLength;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// A file mapped into memory, used for @response files. The mapping is private (copy-on-write), so
+// its owner may rewrite the text in place without touching the file. Platforms without mmap read
+// the file into a heap buffer instead.
+//-------------------------------------------------------------------------------------------------
+
+class SmpMappedFile 
+{
+  public:
+    enum { kOpenOk = 0, kOpenFailed = -1, kOpenTooLarge = -2 };
+
+    SmpMappedFile() : mData( NULL ), mSize( 0 ), mbMapped( false ) {};
+
+    ~SmpMappedFile() { close(); };
+
+    SmpMappedFile( const SmpMappedFile& ) = delete;
+    SmpMappedFile& operator=( const SmpMappedFile& ) = delete;
+
+    // Returns kOpenOk, kOpenFailed, or kOpenTooLarge when the file holds more than 'maxBytes'.
+    int open( const char* path, size_t maxBytes );
+
+    void close();
+
+    char*  data() { return( mData ); };
+    size_t size() const { return( mSize ); };
+
+  protected:
+    char*  mData;
+    size_t mSize;
+    bool   mbMapped;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// SmpParsedArgs: an immutable result of SmpCommandLine::freeze(). Every flagged argument that was
+// extracted by a getter is stored with its final (already converted) value, together with all 
+// remaining unflagged arguments. Everything lives in one flat, position-independent buffer:
+//
+//     Header | Entry[entryCount] | uint32_t slots[slotCount] | Span positionals[] | text pool
+//
+// where 'slots' is an open-addressing hash over the flag names. Nothing is modified after 
+// construction, so any number of threads may read one SmpParsedArgs concurrently without locks.
+//
+// The buffer is also a snapshot format (native byte order, versioned by kVersion): writeSnapshot()
+// puts it into a memfd, and another process attaches to it with fromSnapshot( fd ), reading the 
+// values in place, with neither tokenization nor numeric conversion.
+//
+// A flag is looked up as "r"/"-r" (short) or "radius"/"--radius" (long); without hyphens, a 
+// one-letter flag is taken as a short flag. Getters return 'defaultValue' only for flags that 
+// were never extracted from the SmpCommandLine; otherwise the default given back then applies.
+//-------------------------------------------------------------------------------------------------
+
+class SmpParsedArgs 
+{
+  public:
+    static const uint32_t kMagic   = 0x50504D53; // "SMPP"
+    static const uint32_t kVersion = 1;
+
+    enum ValueType { kInteger = 0, kUnsigned, kReal, kString, kBoolean, kList };
+
+    SmpParsedArgs() : mBase( NULL ), mSize( 0 ) {};
+
+    bool has( const char* flag ) const
+    {
+        const Entry* entry = findEntry( flag );
+        return( entry != NULL && entry->present != 0 );
+    };
+
+    int      getInteger( const char* flag, int defaultValue = 0 ) const          { return( (int)getInt64( flag, defaultValue ) ); };
+    float    getFloat( const char* flag, float defaultValue = 0.0 ) const        { return( (float)getDouble( flag, defaultValue ) ); };
+
+    int64_t getInt64( const char* flag, int64_t defaultValue = 0 ) const
+    {
+        const Entry* entry = findEntry( flag );
+        return( entry != NULL ? entry->intValue : defaultValue );
+    };
+
+    uint64_t getUInt64( const char* flag, uint64_t defaultValue = 0 ) const
+    {
+        const Entry* entry = findEntry( flag );
+        return( entry != NULL ? (uint64_t)entry->intValue : defaultValue );
+    };
+
+    double getDouble( const char* flag, double defaultValue = 0.0 ) const
+    {
+        const Entry* entry = findEntry( flag );
+        return( entry != NULL ? entry->realValue : defaultValue );
+    };
+
+    std::string_view getString( const char* flag, std::string_view defaultValue = "" ) const
+    {
+        const Entry* entry = findEntry( flag );
+        return( entry != NULL ? text( entry->textOffset, entry->textLength ) : defaultValue );
+    };
+
+    bool getBoolean( const char* flag ) const
+    {
+        const Entry* entry = findEntry( flag );
+        return( entry != NULL && entry->intValue != 0 );
+    };
+
+    // Unflagged arguments, counted from 1 as in SmpCommandLine::getString( index, ... ).
+    size_t positionalCount() const { return( mBase != NULL ? header()->positionalCount : 0 ); };
+
+    std::string_view getString( int index, std::string_view defaultValue = "" ) const
+    {
+        if( index < 1 || (size_t)index > positionalCount() )
+            return( defaultValue );
+        const Span& span = spans()[index-1];
+        return( text( span.offset, span.length ) );
+    };
+
+    std::string_view programName() const 
+    { 
+        return( mBase != NULL ? text( header()->programOffset, header()->programLength ) : std::string_view() ); 
+    };
+
+    // The flat buffer itself, e.g. to copy it elsewhere.
+    const void* data() const { return( mBase ); };
+    size_t      size() const { return( mSize ); };
+
+    // False for a default-constructed SmpParsedArgs, or a snapshot that could not be attached.
+    bool valid() const { return( mBase != NULL ); };
+
+    // Writes the buffer into a new memfd (an anonymous in-memory file, sealed against changes; a 
+    // deleted temporary file where memfd is missing) and returns its descriptor, or -1 on failure.
+    // The descriptor is inherited by forked children, also across exec, e.g. pass its number as
+    // an argument and attach with fromSnapshot( fd ) in the child.
+    int writeSnapshot() const;
+
+    // Attaches to a snapshot written by writeSnapshot(): the file is mapped read-only and checked,
+    // nothing is parsed. Returns an invalid SmpParsedArgs (see valid()) if the file is not a 
+    // snapshot of this version. 'fd' may be closed afterwards.
+    static SmpParsedArgs fromSnapshot( int fd );
+
+    // Same as above, for a snapshot already in memory (e.g. a shared memory segment, 8-byte 
+    // aligned), which has to stay there as long as the SmpParsedArgs and its copies are used.
+    static SmpParsedArgs fromSnapshot( const void* data, size_t size )
+    {
+        if( !isValidBuffer( (const char*)data, size ) ) {
+            _ERROR_MESSAGE( "No valid snapshot at %p (version %u expected).\n", data, kVersion );
+            return( SmpParsedArgs() );
+        }
+        return( SmpParsedArgs( std::shared_ptr<const void>(), (const char*)data, ( (const Header*)data )->size ) );
+    };
+
+  protected:
+    friend class SmpCommandLine;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t size;             // of the whole buffer, in bytes
+        uint32_t entryCount;
+        uint32_t slotCount;        // a power of 2
+        uint32_t positionalCount;
+        uint32_t entriesOffset;    // all offsets are relative to the buffer start
+        uint32_t slotsOffset;
+        uint32_t positionalsOffset;
+        uint32_t poolOffset;
+        uint32_t programOffset;    // relative to the text pool, as are all text offsets
+        uint32_t programLength;
+    };
+
+    struct Entry {
+        int64_t  intValue;         // integers, unsigned (as bits) and booleans; reals truncated
+        double   realValue;        // reals; integers converted
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t textOffset;       // the argument text (or the default, for strings)
+        uint32_t textLength;
+        uint8_t  hyphens;          // 1 for a short flag, 2 for a long one
+        uint8_t  type;             // ValueType
+        uint8_t  present;          // given in the command line
+        uint8_t  reserved[5];
+    };
+
+    struct Span {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    std::shared_ptr<const void> mHolder;  // keeps the buffer alive; shared between copies
+    const char*                 mBase;
+    size_t                      mSize;
+
+    SmpParsedArgs( std::shared_ptr<const void> holder, const char* base, size_t size ) 
+        : mHolder( holder ), mBase( base ), mSize( size ) {};
+
+    // Checks a buffer of unknown origin, so that no lookup in it can read out of bounds or loop.
+    static bool isValidBuffer( const char* base, size_t size );
+
+    const Header* header() const  { return( (const Header*)mBase ); };
+    const Entry*  entries() const { return( (const Entry*)( mBase + header()->entriesOffset ) ); };
+    const uint32_t* slots() const { return( (const uint32_t*)( mBase + header()->slotsOffset ) ); };
+    const Span*   spans() const   { return( (const Span*)( mBase + header()->positionalsOffset ) ); };
+
+    std::string_view text( uint32_t offset, uint32_t length ) const
+    {
+        return( std::string_view( mBase + header()->poolOffset + offset, length ) );
+    };
+
+    static uint32_t hashKey( int hyphens, std::string_view name )
+    {
+        uint32_t h = 2166136261u ^ (uint32_t)hyphens; // FNV-1a
+        for( size_t i = 0; i < name.size(); i++ ) {
+            h = ( h ^ (unsigned char)name[i] ) * 16777619u;
+        }
+        return( h );
+    };
+
+    const Entry* findEntry( const char* flag ) const;
+};
+
+
+// Enumerated choices for SmpCommandLine::getChoice(), defined with the compile-time option schema.
+template< typename Enum > struct SmpChoice;
+template< typename Enum, size_t N > class SmpChoices;
+
+
+// A problem found by SmpCommandLine::checkValidity() in the arguments the getters left over, or
+// by a try-getter (SmpCommandLine::tryGet()) in the argument it converted. kSmpUsageError is a 
+// try-getter called in a way the getters report as a source usage error. kSmpUnterminatedQuote is
+// a command string or response file ending inside a quote (or with a backslash): the argument 
+// begun there is dropped, and kept as the diagnostic's text.
+enum SmpDiagnosticKind { kSmpUnknownFlag = 1, kSmpMissingValue, kSmpUnexpectedArgument, kSmpInvalidValue, kSmpUsageError, 
+                         kSmpUnterminatedQuote };
+
+struct SmpDiagnostic
+{
+    SmpDiagnosticKind kind;
+    std::string_view  text;        // the argument as given (for kSmpMissingValue: its flag; for
+                                   // kSmpUsageError: what is wrong)
+    int               position;    // in the command line, the program name being 0; -1 if the
+                                   // value came from the environment or a config file
+    int               suggestionHyphens;
+    std::string_view  suggestion;  // closest registered flag (kSmpUnknownFlag), empty if none
+    std::string_view  flag;        // the flag of an invalid value, empty for unflagged arguments
+    SmpConvertError   convertError;  // why the value is invalid (kSmpInvalidValue)
+};
+
+// Result of a try-getter: the value, or the SmpDiagnostic saying why there is none. It is 
+// std::expected<T, SmpDiagnostic> with C++23; otherwise SmpResult below offers the same members
+// (has_value(), value(), value_or(), error(), operator*), so that callers compile against both.
+#if defined(__cpp_lib_expected)
+
+template< typename T >
+using SmpResult = std::expected<T, SmpDiagnostic>;
+using SmpUnexpected = std::unexpected<SmpDiagnostic>;
+
+#else
+
+class SmpUnexpected 
+{
+  public:
+    explicit SmpUnexpected( const SmpDiagnostic& error ) : mError( error ) {};
+
+    const SmpDiagnostic& error() const { return( mError ); };
+
+  protected:
+    SmpDiagnostic mError;
+};
+
+template< typename T >
+class SmpResult 
+{
+  public:
+    typedef T             value_type;
+    typedef SmpDiagnostic error_type;
+
+    SmpResult( const T& value ) : mValue( value ), mError(), mbHasValue( true ) {};
+    SmpResult( const SmpUnexpected& failure ) : mValue(), mError( failure.error() ), mbHasValue( false ) {};
+
+    bool has_value() const { return( mbHasValue ); };
+    explicit operator bool() const { return( mbHasValue ); };
+
+    // Only with a value: asserted in debug builds; otherwise they return T() (std::expected would 
+    // throw instead).
+    const T& value() const      { assert( mbHasValue ); return( mValue ); };
+    const T& operator*() const  { assert( mbHasValue ); return( mValue ); };
+    const T* operator->() const { assert( mbHasValue ); return( &mValue ); };
+
+    T value_or( const T& otherValue ) const { return( mbHasValue ? mValue : otherValue ); };
+
+    const SmpDiagnostic& error() const { return( mError ); };
+
+  protected:
+    T             mValue;
+    SmpDiagnostic mError;
+    bool          mbHasValue;
+};
+
+#endif
+
+
+class SmpCommandLine 
+{
+  private:
+    static constexpr const char* _VERSION_NUMBER_ = "SmpCommandLine V2.1.0, Dennis @ 2021-2025";
+  
   protected:
+    template< typename Config > friend class SmpOptionBinder;
+
+    // Constants are static, so constructing (or resetting) a parser does not build any of them.
+    static constexpr char kHyphenchar = '-';
+    static constexpr std::string_view kSingleHyphen = std::string_view("-");
+    static constexpr std::string_view kDoubleHyphen = std::string_view("--");
+    static constexpr std::string_view kEmptyString  = std::string_view("");
+    static constexpr std::string_view kSpaceString  = std::string_view(" ");
+    static constexpr std::string_view kNoValue = std::string_view();
+    static constexpr std::string_view kFlagOnlyValue = std::string_view(" ");
+
+    // Backing text of the flags split out of combined short flags ('-xzvf'), so that every token
+    // can be a view: the split flag '-z' points at "-z" in here.
+    static constexpr const char* kShortFlagTexts = "-a-b-c-d-e-f-g-h-i-j-k-l-m-n-o-p-q-r-s-t-u-v-w-x-y-z"
+                                                   "-A-B-C-D-E-F-G-H-I-J-K-L-M-N-O-P-Q-R-S-T-U-V-W-X-Y-Z";
+    static constexpr bool bQuitOnError = false;
+
+    // Token table: argv is classified once in the constructor. Tokens are views into argv (which
+    // lives as long as the process), getters mark them as consumed instead of erasing them, and 
+    // locate flags through 'flagIndex' rather than scanning.
+    enum TokenKind { kPositionalToken = 0, kFlagToken, kValueToken };
+
+    struct Token {
+        std::string_view text;
+        int         hyphens;      // length of the flag prefix ('-' or '--'), 0 for non-flags
+        TokenKind   kind;
+        bool        consumed;
+        int         nextLive;     // skip link to the next unconsumed token (path-compressed)
+        int         nextSameFlag; // next token with identical flag text, -1 for none
+    };
+
+#if defined(SMP_LOW_STARTUP)
+    // Inline storage of the tables: a command line of typical size needs no heap at all.
+    struct InlineArena {
+        alignas(std::max_align_t) char      storage[ SMP_INLINE_STORAGE ];
+        std::pmr::monotonic_buffer_resource resource;
+
+        InlineArena() : resource( storage, sizeof(storage), std::pmr::get_default_resource() ) {};
+    };
+    InlineArena mInlineArena;
+#endif
+
+    // Every container below allocates from 'mResource', which is the default heap (the inline
+    // storage with SMP_LOW_STARTUP) unless the caller passes its own memory_resource (e.g. a 
+    // monotonic arena) to the constructor.
+    std::pmr::memory_resource* mResource;
+
+    std::pmr::memory_resource* defaultResource()
+    {
+#if defined(SMP_LOW_STARTUP)
+        return( &mInlineArena.resource );
+#else
+        return( std::pmr::get_default_resource() );
+#endif
+    };
+
+    std::pmr::vector<Token> tokens;
+    std::pmr::vector<int>   flagIndex;  // open-addressing hash: slot -> first token of a flag chain, -1 if empty
+    // Help descriptors: getters only record what they were asked for, the help text itself is 
+    // composed by showHelpMessage(). 'helpMsg' is kept as a pointer, so it has to stay valid until
+    // then (string literals, as in the demo, always do).
+    enum HelpValueType { kHelpInteger = 0, kHelpUnsigned, kHelpReal, kHelpString, kHelpBoolean, kHelpList, 
+                         kHelpDuration, kHelpBytes, kHelpCount };
+
+    // The layers a flag value may come from, in order of precedence (the default comes last).
+    enum ValueSource { kFromDefault = 0, kFromCommandLine, kFromEnvironment, kFromConfigFile };
+
+    struct HelpItem {
+        const char*   shortFlag;   // NULL for unflagged arguments
+        const char*   longFlag;
+        int           index;       // position of an unflagged argument, 0 for flagged ones
+        HelpValueType type;
+        bool          bFlagOnly;   // flagged boolean: flag without a value, default always false
+        char          separator;   // element separator of kHelpList items
+        long long     intDefault;  // also holds the bits of kHelpUnsigned (and kHelpBytes...) defaults
+        double        realDefault;
+        size_t        textOffset;  // string defaults (and nothing else) are copied into helpTextPool
+        size_t        textLength;
+        size_t        choicesOffset; // the names of getChoice() choices, also in helpTextPool
+        size_t        choicesLength;
+        const char*   helpMsg;
+        ValueSource   source;      // where the value came from (kFromDefault if nowhere), with
+        std::string_view value;    // its text (kFlagOnlyValue for a flag without value)
+    };
+
+    std::pmr::vector<HelpItem> helpItems;
+    std::pmr::string           helpTextPool;
+
+    // @response files whose text the tokens point into, and config files whose text configEntries
+    // point into (kept by reset(), unlike the response files). Shared, so the parser stays copyable.
+    std::pmr::vector< std::shared_ptr<SmpMappedFile> > responseFiles;
+    std::pmr::vector< std::shared_ptr<SmpMappedFile> > configFiles;
+
+    // Config file entries ('key = value', or 'section.key' within an INI [section]), indexed once
+    // by 'configIndex', an open-addressing hash over the full key: slot -> entry, -1 if empty. 
+    struct ConfigEntry {
+        std::string_view section;
+        std::string_view key;
+        std::string_view value;
+    };
+
+    // Unquoted arguments of a command string (see SmpCommandLine( commandLine )): those with quotes 
+    // or escapes. Shared like the response files; sized once per string, so views stay valid.
+    std::shared_ptr<std::pmr::string> mCommandText;
+
+    std::pmr::vector<ConfigEntry> configEntries;
+    std::pmr::vector<int>         configIndex;
+    std::pmr::string              mEnvironmentPrefix;
+    std::pmr::vector<SmpDiagnostic> mDiagnostics;
+    size_t mResponseFileBytes;
+    size_t mMaxResponseFileBytes;
+
+    int  mArgCount;
+    int  maxUnflaggedArgs;
+    bool mbWarningHasShown;
+    bool mbHelpMsgHasShown;
+    bool mbUnflaggedApiCalled;
+    bool mbAllPositionalsWanted;  // positionals() was called: no unflagged argument is unexpected
+    bool mbQuiet;         // in a try-getter: record problems in mDiagnostics instead of printing
+    int  mLastFlagToken;  // position of the flag found by the last getFlaggedArgument(), -1 if none
+    int  mCursorIndex;  // the last unflagged argument looked up: its index, -1 if none (or stale),
+    int  mCursorToken;  // and its position in the token table
+ 
+  // Below are Public Methods:
+  public:
+
+    // An argument '@path' is replaced by the arguments listed in file 'path' (the response file), 
+    // which may in turn contain '@path' arguments. 'maxResponseFileBytes' caps the total size of 
+    // all response files read; an '@path' that can not be read is kept as a normal argument.
+    SmpCommandLine( int argc, char *const argv[], size_t maxResponseFileBytes = SMP_RESPONSE_FILE_LIMIT );
+
+    // Same as above, with all internal storage allocated from 'resource'. With a monotonic arena,
+    // e.g. std::pmr::monotonic_buffer_resource, destroying the parser frees nothing one by one; 
+    // releasing the arena does it all. 'resource' has to outlive the SmpCommandLine (NULL: the default).
+    SmpCommandLine( int argc, char *const argv[], std::pmr::memory_resource* resource, 
+                    size_t maxResponseFileBytes = SMP_RESPONSE_FILE_LIMIT );
+
+    // Builds the parser from one command string, e.g. a line of a job log or a control message,
+    // split into arguments as a POSIX shell would split it (quotes and backslash escapes, see 
+    // SmpSplit::nextShellArgument()); the first word is the program name. Arguments are views into 
+    // 'commandLine', which has to outlive the parser; only those with quotes or escapes are 
+    // unquoted into a buffer of the parser. Flags are then split and looked up as from argv. A 
+    // quote left open drops the argument it begins, which is reported (see kSmpUnterminatedQuote).
+    explicit SmpCommandLine( std::string_view commandLine, size_t maxResponseFileBytes = SMP_RESPONSE_FILE_LIMIT );
+
+    SmpCommandLine( std::string_view commandLine, std::pmr::memory_resource* resource, 
+                    size_t maxResponseFileBytes = SMP_RESPONSE_FILE_LIMIT );
+
+    // Extract flagged argument of int type
+    int getInteger( const char* shortFlag, const char* longFlag, int defaultValue = 0, const char* helpMsg = "" );
+
+    // Extract unflagged argument of int type
+    int getInteger( int index, int defaultValue = 0, const char* helpMsg = "" );
+
+    // Extract flagged argument of float type
+    float getFloat( const char* shortFlag, const char* longFlag, float defaultValue = 0.0, const char* helpMsg = "" );
+
+    // Extract unflagged argument of float type
+    float getFloat( int index, float defaultValue = 0.0, const char* helpMsg = "" );
+
+    // Extract flagged argument of double type
+    double getDouble( const char* shortFlag, const char* longFlag, double defaultValue = 0.0, const char* helpMsg = "" );
+
+    // Extract unflagged argument of double type
+    double getDouble( int index, double defaultValue = 0.0, const char* helpMsg = "" );
+
+    // Extract flagged argument of 64-bit integer type
+    int64_t getInt64( const char* shortFlag, const char* longFlag, int64_t defaultValue = 0, const char* helpMsg = "" );
+
+    // Extract unflagged argument of 64-bit integer type
+    int64_t getInt64( int index, int64_t defaultValue = 0, const char* helpMsg = "" );
+
+    // Extract flagged argument of unsigned 64-bit integer type
+    uint64_t getUInt64( const char* shortFlag, const char* longFlag, uint64_t defaultValue = 0, const char* helpMsg = "" );
+
+    // Extract unflagged argument of unsigned 64-bit integer type
+    uint64_t getUInt64( int index, uint64_t defaultValue = 0, const char* helpMsg = "" );
+
+    // Extract flagged argument of size_t type (counts, byte offsets)
+    size_t getSize( const char* shortFlag, const char* longFlag, size_t defaultValue = 0, const char* helpMsg = "" );
+
+    // Extract unflagged argument of size_t type (counts, byte offsets)
+    size_t getSize( int index, size_t defaultValue = 0, const char* helpMsg = "" );
+
+    // Extract flagged argument of a duration with its unit, e.g. '--timeout 250ms' or '1.5s' (see 
+    // SmpUnits::kDuration; a number without unit is invalid). The default is shown in the help 
+    // message in the largest unit that fits.
+    std::chrono::nanoseconds getDuration( const char* shortFlag, const char* longFlag, 
+                                          std::chrono::nanoseconds defaultValue = std::chrono::nanoseconds( 0 ), const char* helpMsg = "" );
+
+    // Extract unflagged argument of a duration with its unit
+    std::chrono::nanoseconds getDuration( int index, std::chrono::nanoseconds defaultValue = std::chrono::nanoseconds( 0 ), 
+                                          const char* helpMsg = "" );
+
+    // Extract flagged argument of a byte size, e.g. '--cache 4GiB' (see SmpUnits::kBytes; 'k', 'M', 
+    // 'G' are powers of 1024, 'kB', 'MB', 'GB' powers of 1000, no unit is bytes)
+    uint64_t getBytes( const char* shortFlag, const char* longFlag, uint64_t defaultValue = 0, const char* helpMsg = "" );
+
+    // Extract unflagged argument of a byte size
+    uint64_t getBytes( int index, uint64_t defaultValue = 0, const char* helpMsg = "" );
+
+    // Extract flagged argument of a count with an optional metric suffix, e.g. '--rate 10k' (see 
+    // SmpUnits::kCount)
+    uint64_t getCount( const char* shortFlag, const char* longFlag, uint64_t defaultValue = 0, const char* helpMsg = "" );
+
+    // Extract unflagged argument of a count with an optional metric suffix
+    uint64_t getCount( int index, uint64_t defaultValue = 0, const char* helpMsg = "" );
+
+    // Extract flagged argument of a list of int, e.g. '--ids 1,2,3'
+    std::vector<int> getIntegerList( const char* shortFlag, const char* longFlag, char separator = ',', const char* helpMsg = "" );
+
+    // Same as above, but converts into a caller-provided buffer. Returns the number of elements in
+    // the list, which may exceed 'capacity' (only the first 'capacity' ones are stored then).
+    size_t getIntegerList( const char* shortFlag, const char* longFlag, int* values, size_t capacity, 
+                           char separator = ',', const char* helpMsg = "" );
+
+    // Extract flagged argument of a list of double, e.g. '--weights 0.5,0.25,0.25'
+    std::vector<double> getDoubleList( const char* shortFlag, const char* longFlag, char separator = ',', const char* helpMsg = "" );
+
+    size_t getDoubleList( const char* shortFlag, const char* longFlag, double* values, size_t capacity, 
+                          char separator = ',', const char* helpMsg = "" );
+
+    // Extract flagged argument of a list of strings, e.g. '--tags red,green'. Elements are views 
+    // into argv, no string is allocated per element.
+    std::vector<std::string_view> getStringList( const char* shortFlag, const char* longFlag, char separator = ',', const char* helpMsg = "" );
+
+    size_t getStringList( const char* shortFlag, const char* longFlag, std::string_view* values, size_t capacity, 
+                          char separator = ',', const char* helpMsg = "" );
+
+    // Extract flagged argument of an enumerated type, e.g. '--filter box': the text is matched with
+    // the names of 'choices' ignoring case, and the value of the matching one is returned. With 
+    // 'choices' a static constexpr SmpChoices, the perfect hash over the names is built at compile
+    // time. The help message lists the choices.
+    template< typename Enum, size_t N >
+    Enum getChoice( const char* shortFlag, const char* longFlag, const SmpChoices<Enum, N>& choices, Enum defaultValue, const char* helpMsg = "" )
+    {
+        HelpItem& item = addHelpMessage( shortFlag, longFlag, kHelpString, helpMsg );
+        int defaultIndex = choices.indexOf( defaultValue );
+        setHelpText( item, defaultIndex >= 0 ? choices.name( defaultIndex ) : kNoValue );
+
+        item.choicesOffset = helpTextPool.size();
+        for( size_t i = 0; i < N; i++ ) {
+            if( i > 0 ) 
+                helpTextPool += ", ";
+            helpTextPool += choices.name( i );
+        }
+        item.choicesLength = helpTextPool.size() - item.choicesOffset;
+
+        std::string_view valueString = getFlaggedArgument( shortFlag, longFlag );
+
+        if( valueString.empty() ) 
+            return( defaultValue );
+
+        int k = choices.find( valueString );
+        if( k >= 0 )
+            return( choices.value( k ) );
+
+        _ERROR_MESSAGE( "Invalid choice '%.*s' following flag %s in command line, expected one of: %.*s.\n", 
+                        (int)valueString.size(), valueString.data(), (shortFlag!=NULL? shortFlag:longFlag),
+                        (int)item.choicesLength, helpTextPool.data() + item.choicesOffset );
+        if( bQuitOnError ) {
+            exit(-1);
+        } else { 
+            _DEBUG_MESSAGE( "Use default value.\n" );
+            return( defaultValue );
+        }
+    };
+
+    // Same as above, with the choices given in place, e.g. 
+    //     getChoice<Filter>( "f", "filter", { { "gaussian", kGaussian }, { "box", kBox } }, kBox );
+    // The hash is then built at run time, on every call.
+    template< typename Enum, size_t N >
+    Enum getChoice( const char* shortFlag, const char* longFlag, const SmpChoice<Enum> (&choices)[N], Enum defaultValue, const char* helpMsg = "" )
+    {
+        return( getChoice( shortFlag, longFlag, SmpChoices<Enum, N>( choices ), defaultValue, helpMsg ) );
+    };
+
+    // Extract flagged argument of an integer range, e.g. '--frames 0:10000000:4' or '--seeds 1-1000'
+    // (see SmpRange for the forms). The range is a view that computes its elements as they are 
+    // read, nothing is expanded. 'defaultRange' is given in the same form.
+    template< typename T >
+    SmpRange<T> getRange( const char* shortFlag, const char* longFlag, std::string_view defaultRange = "", const char* helpMsg = "" )
+    {
+        setHelpText( addHelpMessage( shortFlag, longFlag, kHelpString, helpMsg ), defaultRange );
+
+        return( convertRange<T>( getFlaggedArgument( shortFlag, longFlag ), defaultRange, (shortFlag!=NULL? shortFlag:longFlag), 0 ) );
+    };
+
+    // Extract unflagged argument of an integer range
+    template< typename T >
+    SmpRange<T> getRange( int index, std::string_view defaultRange = "", const char* helpMsg = "" )
+    {
+        setHelpText( addHelpMessage( index, kHelpString, helpMsg ), defaultRange );
+
+        return( convertRange<T>( getUnflaggedArgument( index ), defaultRange, NULL, index ) );
+    };
+
+    // Extract flagged argument of bealean type
+    bool getBoolean( const char* shortFlag, const char* longFlag, const char* helpMsg = "" );
+
+
+    // Extract unflagged argument of boolean type
+    bool getBoolean( int index, bool defaultValue=false, const char* helpMsg = "" );
+
+    // Extract flagged argument of string type
+    std::string getString( const char* shortFlag, const char* longFlag, std::string defaultValue = "", const char* helpMsg = "" );
+
+    // Extract unflagged argument of string type
+    std::string getString( int index, std::string defaultValue = "", const char* helpMsg = "" );
+
+    // Extract flagged argument of string type as a view into argv (no copy is made). The returned
+    // view remains valid as long as argv does, and 'defaultValue' is returned as is.
+    std::string_view getStringView( const char* shortFlag, const char* longFlag, std::string_view defaultValue = "", const char* helpMsg = "" );
+
+    // Extract unflagged argument of string type as a view into argv (no copy is made).
+    std::string_view getStringView( int index, std::string_view defaultValue = "", const char* helpMsg = "" );
+
+    //-----------------------------------------------------------------------------------------------
+    // Try-getters: the same lookups without any output and without exit(). T is a number type,
+    // bool or std::string_view:
+    //
+    //     SmpResult<int> width = userCommands.tryGet<int>( "w", "width", 640, "width of image" );
+    //     if( !width ) { ... width.error() ... }
+    //
+    // An absent argument yields 'defaultValue'; an invalid one (or a flag without its value) yields
+    // the SmpDiagnostic, which is also kept in diagnostics(). Call showDiagnostics() to print them.
+    template< typename T >
+    SmpResult<T> tryGet( const char* shortFlag, const char* longFlag, T defaultValue = T(), const char* helpMsg = "" )
+    {
+        setHelpDefault( addHelpMessage( shortFlag, longFlag, helpTypeOf<T>(), helpMsg ), defaultValue, true );
+
+        size_t problems = mDiagnostics.size();
+        mbQuiet = true;
+        std::string_view valueString = getFlaggedArgument( shortFlag, longFlag, std::is_same<T, bool>::value );
+        mbQuiet = false;
+
+        if( mDiagnostics.size() > problems )  // a usage error, or an invalid boolean in a layer
+            return( SmpUnexpected( mDiagnostics.back() ) );
+        if( valueString.empty() )
+            return( defaultValue );
+        if constexpr( std::is_same<T, bool>::value ) {
+            return( true );
+        }
+
+        std::string_view flag = ( mLastFlagToken >= 0 ? tokens[ mLastFlagToken ].text :
+                                  std::string_view( longFlag != NULL ? longFlag : shortFlag ) );
+        if( valueString == kFlagOnlyValue )
+            return( SmpUnexpected( addDiagnostic( kSmpMissingValue, flag, flag, mLastFlagToken, kSmpConvertEmpty ) ) );
+
+        T value = defaultValue;
+        SmpConvertError error = convertText( valueString, value );
+        if( error != kSmpConvertOk )
+            return( SmpUnexpected( addDiagnostic( kSmpInvalidValue, valueString, flag, mLastFlagToken, error ) ) );
+        return( value );
+    };
+
+    // Try-getter of an unflagged argument.
+    template< typename T >
+    SmpResult<T> tryGet( int index, T defaultValue = T(), const char* helpMsg = "" )
+    {
+        setHelpDefault( addHelpMessage( index, helpTypeOf<T>(), helpMsg ), defaultValue, false );
+
+        mbQuiet = true;
+        std::string_view argString = getUnflaggedArgument( index );
+        mbQuiet = false;
+
+        if( argString.empty() )
+            return( defaultValue );
+
+        T value = defaultValue;
+        SmpConvertError error = convertText( argString, value );
+        if( error != kSmpConvertOk )
+            return( SmpUnexpected( addDiagnostic( kSmpInvalidValue, argString, kNoValue, mCursorToken, error ) ) );
+        return( value );
+    };
+
+    //-----------------------------------------------------------------------------------------------
+    // Streaming access to the unflagged arguments: instead of getString( 1 ), getString( 2 ), ...
+    //
+    //     for( std::string_view file : userCommands.positionals() ) { ... }
+    //     for( int n : userCommands.positionalsAs<int>() ) { ... }
+    //
+    // yields every remaining unflagged argument (after the program name) in one forward pass. As
+    // with getXxxx( index, ... ), extract the flagged arguments first.
+
+    class PositionalIterator 
+    {
+      public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef std::string_view          value_type;
+        typedef std::ptrdiff_t            difference_type;
+        typedef const std::string_view*   pointer;
+        typedef std::string_view          reference;
+
+        PositionalIterator( SmpCommandLine* parser, int pos ) : mParser( parser ), mPos( pos ) {};
+
+        std::string_view operator*() const { return( mParser->tokens[mPos].text ); };
+
+        PositionalIterator& operator++() { mPos = mParser->nextPositional( mPos+1 ); return( *this ); };
+        PositionalIterator  operator++(int) { PositionalIterator old = *this; ++(*this); return( old ); };
+
+        bool operator==( const PositionalIterator& other ) const { return( mPos == other.mPos ); };
+        bool operator!=( const PositionalIterator& other ) const { return( mPos != other.mPos ); };
+
+      protected:
+        SmpCommandLine* mParser;
+        int             mPos;
+    };
+
+    class PositionalRange 
+    {
+      public:
+        PositionalRange( SmpCommandLine* parser ) : mParser( parser ) {};
+
+        PositionalIterator begin() const { return( PositionalIterator( mParser, mParser->nextPositional( 1 ) ) ); };
+        PositionalIterator end() const   { return( PositionalIterator( mParser, (int)mParser->tokens.size() ) ); };
+
+      protected:
+        SmpCommandLine* mParser;
+    };
+
+    // Same as PositionalRange, converting every argument to T (an invalid one is reported and 
+    // yields T()).
+    template< typename T >
+    class PositionalRangeAs 
+    {
+      public:
+        class Iterator : public PositionalIterator 
+        {
+          public:
+            typedef T value_type;
+            typedef T reference;
+
+            Iterator( const PositionalIterator& it ) : PositionalIterator( it ) {};
+
+            T operator*() const 
+            { 
+                std::string_view text = PositionalIterator::operator*();
+                T value = T();
+                SmpConvertResult result = SmpConvert::toNumber( text, value );
+                if( result.error != kSmpConvertOk ) {
+                    _ERROR_MESSAGE( "Invalid number '%.*s' in command line: %s at position %d.\n", (int)text.size(), 
+                                    text.data(), SmpConvert::errorString( result.error ), (int)result.position );
+                    value = T();
+                }
+                return( value );
+            };
+
+            Iterator& operator++() { PositionalIterator::operator++(); return( *this ); };
+        };
+
+        PositionalRangeAs( SmpCommandLine* parser ) : mRange( parser ) {};
+
+        Iterator begin() const { return( Iterator( mRange.begin() ) ); };
+        Iterator end() const   { return( Iterator( mRange.end() ) ); };
+
+      protected:
+        PositionalRange mRange;
+    };
+
+    PositionalRange positionals();
+
+    template< typename T >
+    PositionalRangeAs<T> positionalsAs()
+    {
+        mbUnflaggedApiCalled = true;
+        mbAllPositionalsWanted = true;
+        return( PositionalRangeAs<T>( this ) );
+    };
+
+    // Hands the unflagged arguments to 'callback( const std::string_view* items, size_t count )' in
+    // batches of up to 'chunkSize', so that processing can start before the scan is finished. 
+    // Returns the total number of unflagged arguments.
+    template< typename Callback >
+    size_t forEachPositionalChunk( size_t chunkSize, Callback&& callback )
+    {
+        std::pmr::vector<std::string_view> chunk( mResource );
+        size_t total = 0;
+
+        chunkSize = std::max( chunkSize, (size_t)1 );
+        chunk.reserve( chunkSize );
+
+        for( std::string_view item : positionals() ) 
+        {
+            chunk.push_back( item );
+            if( chunk.size() == chunkSize ) {
+                callback( (const std::string_view*)chunk.data(), chunk.size() );
+                total += chunk.size();
+                chunk.clear();
+            }
+        }
+        if( !chunk.empty() ) {
+            callback( (const std::string_view*)chunk.data(), chunk.size() );
+            total += chunk.size();
+        }
+        return( total );
+    };
+
+    void showHelpMessage();
+
+    bool helpMessageWanted( int minArgc = -1 );
+
+    void showHelpMsgOnRequest();
+
+    //  Check the validity of user inputed command line, according to the getArgument functions called
+    //  previously in code: flags none of them asked for (with the closest registered flag as a
+    //  suggestion), flags given without their value, and unflagged arguments beyond those extracted.
+    //  Every problem is kept in diagnostics(), in command line order, together with those of the 
+    //  try-getters, and printed unless 'bReport' is false. Returns -1 if there is any, otherwise 0.
+    int checkValidity( bool bReport = true );
+
+    // Prints the problems kept in diagnostics().
+    void showDiagnostics() const;
+
+    // The problems found by the try-getters and the last checkValidity().
+    const std::pmr::vector<SmpDiagnostic>& diagnostics() const { return( mDiagnostics ); };
+
+    // Returns an immutable snapshot of everything extracted so far: the value of every flagged 
+    // argument requested by a getXxxx( shortFlag, longFlag, ... ) call (or its default), and all 
+    // remaining unflagged arguments. Call it after the getters; the snapshot may then be shared 
+    // by any number of threads. All text is copied, so it does not depend on argv or this parser.
+    SmpParsedArgs freeze();
+
+    // Attaches to a snapshot written by SmpParsedArgs::writeSnapshot(), e.g. in a worker process
+    // forked by the one that parsed the command line. See SmpParsedArgs::fromSnapshot().
+    static SmpParsedArgs fromSnapshot( int fd );
+
+    // Replaces the program name (argv[0]) shown in the help message. 'name' is not copied.
+    void setProgramName( std::string_view name );
+
+    // Flags missing from the command line are then looked up in the environment variables named
+    // PREFIX_FLAGNAME (the long flag name in upper case, '-' as '_'; then the short one), e.g. 
+    // MYAPP_RADIUS for "--radius" with prefix "MYAPP". Call it before the getters.
+    void setEnvironmentPrefix( const char* prefix );
+
+    // Flags missing from both the command line and the environment are then looked up in the 
+    // config file 'path': one 'flagname = value' per line, '#' or ';' comments, and INI sections,
+    // where 'key' under '[section]' is the flag 'section.key'. The file is mapped and indexed 
+    // once; a later file overrides the keys of an earlier one. Call it before the getters.
+    bool loadConfigFile( const char* path );
+
+    // Parses another command line with this parser, as if it were newly constructed, but reusing
+    // the capacity of its tables (tokens, flag index, help items): once they have grown to fit the
+    // largest command line seen, reset() and the getters allocate nothing (except getString(), 
+    // which returns a std::string, and @response files). The environment prefix and loaded config
+    // files are kept. For control messages arriving at a high rate, e.g.:
+    //     parser.reset( messageArgc, messageArgv );
+    //     int level = parser.getInteger( "l", "level", 0 );
+    void reset( int argc, char *const argv[] );
+
+    // Same as above, for a command string as taken by SmpCommandLine( commandLine ).
+    void reset( std::string_view commandLine );
+
+    void showVersionInfo();
+
+
+  //-----------------------------------------------------------------------------------------------
+  // Below are private / protected Methods:
+
+    // Builds the token table of argv into the (empty) tables, and resets the extraction state.
+    void parse( int argc, char *const argv[] );
+
+    // Same as above, for a command string split by SmpSplit::nextShellArgument().
+    void parse( std::string_view commandLine );
+
+    void finishParse();
+
+    // Reports the argument that SmpSplit::nextShellArgument() found unterminated, and drops it.
+    void reportUnterminated( std::string_view arg );
+  protected:
+
+    std::string bool2String( bool torf );
+
+    static bool string2Bool( std::string_view boolName, bool defaultValue = false, int *pErrorCode = NULL );
+
+    static bool equalsIgnoreCase( std::string_view a, std::string_view b );
+
+    std::string_view getFlaggedArgument( const char* shortFlag, const char* longFlag, bool bIsBoolean=false );
+
+    // Looks up a flag missing from the command line in the environment, then in the config file.
+    std::string_view getLayeredArgument( const char* shortFlag, const char* longFlag, bool bIsBoolean );
+
+    // Keeps the value with the help item of the calling getter, for the help message and freeze().
+    void recordValueSource( const char* shortFlag, const char* longFlag, ValueSource source, std::string_view value );
+
+    // getenv( PREFIX_NAME ), with NAME in upper case and '-' or '.' replaced by '_'.
+    const char* getEnvironmentValue( std::string_view name ) const;
+
+    std::string_view getUnflaggedArgument( int index );
+
+    template< typename T >
+    T convertFlagged( const char* shortFlag, const char* longFlag, T defaultValue )
+    {
+        std::string_view valueString = getFlaggedArgument( shortFlag, longFlag );
+
+        if( valueString.empty() ) 
+            return( defaultValue );
+
+        T value = defaultValue;
+        SmpConvertResult result = SmpConvert::toNumber( valueString, value );
+
+        if( result.error == kSmpConvertOk )
+            return( value );
+
+        _ERROR_MESSAGE( "Invalid number following flag %s in command line: %s at position %d of '%.*s'.\n", 
+                        (shortFlag!=NULL? shortFlag:longFlag), SmpConvert::errorString( result.error ),
+                        (int)result.position, (int)valueString.size(), valueString.data() );
+        if( bQuitOnError ) {
+            exit(-1);
+        } else { 
+            _DEBUG_MESSAGE( "Use default value.\n" );
+            return( defaultValue );
+        }    
+    };
+
+    template< typename T >
+    T convertUnflagged( int index, T defaultValue )
+    {
+        std::string_view valueString = getUnflaggedArgument( index );
+
+        if( valueString.empty() ) 
+            return( defaultValue );
+
+        T value = defaultValue;
+        SmpConvertResult result = SmpConvert::toNumber( valueString, value );
+
+        if( result.error == kSmpConvertOk )
+            return( value );
+
+        _ERROR_MESSAGE( "Invalid number at position %d in command line: %s at position %d of '%.*s'.\n", index,
+                        SmpConvert::errorString( result.error ), (int)result.position, 
+                        (int)valueString.size(), valueString.data() );
+        if( bQuitOnError ) {
+            exit(-1);
+        } else { 
+            _DEBUG_MESSAGE( "Use default value.\n" );
+            return( defaultValue );
+        }    
+    };
+
+    // The units of kHelpDuration, kHelpBytes and kHelpCount items, NULL for other types.
+    static const SmpUnit* unitsOf( HelpValueType type );
+
+    // The value of 'valueString' (of the flag 'flag', or of unflagged argument 'index' if 'flag' is
+    // NULL) in 'units', at most 'maxValue'; 'defaultValue' if it is absent or invalid.
+    uint64_t convertWithUnit( std::string_view valueString, const SmpUnit* units, uint64_t maxValue, uint64_t defaultValue, 
+                              const char* flag, int index );
+
+    // The range of 'valueString' (of the flag 'flag', or of unflagged argument 'index' if 'flag' is
+    // NULL); the range of 'defaultRange' if it is absent or invalid. An invalid default is empty.
+    template< typename T >
+    SmpRange<T> convertRange( std::string_view valueString, std::string_view defaultRange, const char* flag, int index )
+    {
+        SmpRange<T> range;
+
+        if( !valueString.empty() ) 
+        {
+            SmpConvertResult result = SmpRange<T>::parse( valueString, range );
+
+            if( result.error == kSmpConvertOk )
+                return( range );
+
+            if( flag != NULL ) {
+                _ERROR_MESSAGE( "Invalid range following flag %s in command line: %s at position %d of '%.*s'.\n", 
+                                flag, SmpConvert::errorString( result.error ), (int)result.position, 
+                                (int)valueString.size(), valueString.data() );
+            } else {
+                _ERROR_MESSAGE( "Invalid range at position %d in command line: %s at position %d of '%.*s'.\n", index,
+                                SmpConvert::errorString( result.error ), (int)result.position, 
+                                (int)valueString.size(), valueString.data() );
+            }
+            if( bQuitOnError ) {
+                exit(-1);
+            } else { 
+                _DEBUG_MESSAGE( "Use default value.\n" );
+            }
+        }
+
+        SmpRange<T>::parse( defaultRange, range );
+        return( range );
+    };
+
+    template< typename T >
+    std::vector<T> extractList( const char* shortFlag, const char* longFlag, char separator, const char* helpMsg )
+    {
+        addHelpMessage( shortFlag, longFlag, kHelpList, helpMsg ).separator = separator;
+
+        std::vector<T> values;
+        std::string_view valueString = getFlaggedArgument( shortFlag, longFlag );
+
+        if( valueString.empty() || valueString == kFlagOnlyValue ) 
+            return( values );
+
+        values.resize( SmpSplit::count( valueString, separator ) + 1 );
+        if( !convertList( valueString, separator, values.data(), values.size(), (shortFlag!=NULL? shortFlag:longFlag) ) ) {
+            values.clear();
+        }
+        return( values );
+    };
+
+    template< typename T >
+    size_t extractList( const char* shortFlag, const char* longFlag, T* values, size_t capacity, char separator, const char* helpMsg )
+    {
+        addHelpMessage( shortFlag, longFlag, kHelpList, helpMsg ).separator = separator;
+
+        std::string_view valueString = getFlaggedArgument( shortFlag, longFlag );
+
+        if( valueString.empty() || valueString == kFlagOnlyValue ) 
+            return( 0 );
+
+        size_t count = SmpSplit::count( valueString, separator ) + 1;
+        if( !convertList( valueString, separator, values, std::min( count, capacity ), (shortFlag!=NULL? shortFlag:longFlag) ) ) {
+            return( 0 );
+        }
+        return( count );
+    };
+
+    // Splits 'text' and converts its first 'capacity' elements into 'values'.
+    template< typename T >
+    bool convertList( std::string_view text, char separator, T* values, size_t capacity, const char* flag )
+    {
+        size_t start = 0;
+
+        for( size_t n = 0; n < capacity; n++ ) 
+        {
+            size_t end = SmpSplit::find( text, start, separator );
+            std::string_view element = text.substr( start, end - start );
+
+            if constexpr ( std::is_same<T, std::string_view>::value ) {
+                values[n] = element;
+            } else {
+                SmpConvertResult result = SmpConvert::toNumber( element, values[n] );
+
+                if( result.error != kSmpConvertOk ) {
+                    _ERROR_MESSAGE( "Invalid number in the list following flag %s in command line: %s at position %d of element %d '%.*s'.\n", 
+                                    flag, SmpConvert::errorString( result.error ), (int)result.position, (int)n+1, 
+                                    (int)element.size(), element.data() );
+                    if( bQuitOnError ) {
+                        exit(-1);
+                    } else { 
+                        _DEBUG_MESSAGE( "Use default value (empty list).\n" );
+                        return( false );
+                    }    
+                }
+            }
+            start = end + 1;
+        }
+        return( true );
+    };
+
+    //-----------------------------------------------------------------------------------------------
+    // Token table helpers:
+
+    static bool isFlagLetter( char c );
+
+    // A flag as stored in the index: its hyphen prefix length and the name after it.
+    struct FlagKey {
+        int              hyphens = 0;
+        std::string_view name;
+
+        bool is( int h, std::string_view n ) const { return( hyphens == h && name == n ); }
+    };
+
+    // 'defaultHyphens' is the prefix implied when 'flag' is given without any hyphen.
+    static FlagKey makeFlagKey( std::string_view flag, int defaultHyphens );
+
+    static FlagKey tokenFlagKey( const Token& token );
+
+    // Appends one command line argument to the token table. 'depth' is the response file nesting.
+    void appendArgument( std::string_view arg, int depth );
+
+    // Maps a response file and appends its arguments, which stay views into the mapping. Returns
+    // false when the file can not be used; the '@path' argument is then kept as it is.
+    bool expandResponseFile( std::string_view path, int depth );
+
+    static std::string_view shortFlagText( char letter );
+
+    void appendToken( std::string_view text );
+
+    std::string_view programName() const;
+
+    static size_t hashFlag( const FlagKey& key );
+
+    static size_t hashName( std::string_view name, size_t h = 2166136261u ); // FNV-1a, chainable
+
+    static std::string_view trimSpaces( std::string_view text );
+
+    static size_t hashConfigEntry( const ConfigEntry& entry );
+
+    // Does 'entry' stand for the flag 'name' ('section.key', or just 'key' outside of sections)?
+    static bool configEntryIs( const ConfigEntry& entry, std::string_view name );
+
+    // Later entries replace earlier ones with the same key.
+    void buildConfigIndex();
+
+    // Returns the config entry of flag 'name', or -1.
+    int findConfigEntry( std::string_view name ) const;
+
+    // Returns the slot of 'key' in flagIndex, or the empty slot where it would be inserted.
+    size_t findFlagSlot( const FlagKey& key ) const;
+
+    void buildFlagIndex();
+
+    // Returns the position of the first unconsumed token carrying flag 'key', or -1.
+    int findFlagToken( const FlagKey& key );
+
+    // Position of the first unconsumed unflagged token at or after 'i' (tokens.size() if none).
+    int nextPositional( int i );
+
+    void consumeToken( int i );
+
+    // Returns the position of the first unconsumed token at or after 'i' (tokens.size() if none).
+    int nextUnconsumed( int i );
+
+    // Position of the consumed flag token spelled as 'shortFlag' or 'longFlag', -1 if none.
+    int findConsumedFlag( const char* shortFlag, const char* longFlag ) const;
+
+    // Sets the suggestion of an unknown flag: the registered flag nearest in edit distance, if it 
+    // is within a third of the flag's length. Of equally near ones, the first with the same number
+    // of hyphens wins.
+    void suggestFlag( const Token& token, SmpDiagnostic& diagnostic ) const;
+
+    const SmpDiagnostic& addDiagnostic( SmpDiagnosticKind kind, std::string_view text, std::string_view flag, int position, 
+                                        SmpConvertError error );
+
+    // The help item type and default of a try-getter's T.
+    template< typename T >
+    static constexpr HelpValueType helpTypeOf()
+    {
+        static_assert( std::is_arithmetic<T>::value || std::is_same<T, std::string_view>::value, 
+                       "tryGet<T>: T has to be a number type, bool or std::string_view" );
+        if constexpr( std::is_same<T, bool>::value )
+            return( kHelpBoolean );
+        else if constexpr( std::is_same<T, std::string_view>::value )
+            return( kHelpString );
+        else if constexpr( std::is_floating_point<T>::value )
+            return( kHelpReal );
+        else if constexpr( std::is_unsigned<T>::value )
+            return( kHelpUnsigned );
+        else
+            return( kHelpInteger );
+    };
+
+    template< typename T >
+    void setHelpDefault( HelpItem& item, const T& defaultValue, bool bFlagged )
+    {
+        if constexpr( std::is_same<T, std::string_view>::value ) {
+            setHelpText( item, defaultValue );
+        } else if constexpr( std::is_floating_point<T>::value ) {
+            item.realDefault = defaultValue;
+        } else {
+            item.intDefault = (long long)defaultValue;
+            item.bFlagOnly = ( bFlagged && std::is_same<T, bool>::value );
+        }
+    };
+
+    // Converts the text of an argument to T, without output.
+    template< typename T >
+    static SmpConvertError convertText( std::string_view text, T& value )
+    {
+        if constexpr( std::is_same<T, std::string_view>::value ) {
+            value = text;
+            return( kSmpConvertOk );
+        } else if constexpr( std::is_same<T, bool>::value ) {
+            int errorCode;
+            value = string2Bool( text, value, &errorCode );
+            return( errorCode == 0 ? kSmpConvertOk : kSmpConvertInvalid );
+        } else {
+            return( SmpConvert::toNumber( text, value ).error );
+        }
+    };
+
+    HelpItem& addHelpMessage( const char* shortFlag, const char* longFlag, HelpValueType type, const char* helpMsg );
+
+    static size_t alignUp( size_t size ) { return( ( size + 7 ) & ~(size_t)7 ); };
+
+    // Final value of a flagged help item for freeze(): the converted argument, or the default when
+    // the flag is absent or its argument is invalid.
+    void resolveHelpValue( const HelpItem& item, SmpParsedArgs::Entry& entry, std::pmr::string& pool );
+
+    void setHelpText( HelpItem& item, std::string_view text );
+
+    std::string_view helpText( const HelpItem& item ) const;
+
+    static void appendNumber( std::pmr::string& out, long long number );
+
+    HelpItem& addHelpMessage( int index, HelpValueType type, const char* helpMsg );
+
+    // Appends the '-s/--long val' (or 'argumentN') column of a help item, returns its length.
+    size_t appendHelpColumn( std::pmr::string& out, const HelpItem& item );
+
+    // Appends the default value of a help item, returns false if there is none to show.
+    bool appendHelpDefault( std::pmr::string& out, const HelpItem& item );
+
+    void composeHelpMessage( std::pmr::string& message );
+
+    // Forbid calling of default constructor (force user to pass argc and argv into constructor method
+    // (defined below):
+    SmpCommandLine();
+}; 
+
+
+//-------------------------------------------------------------------------------------------------
+// Git-style subcommands ('tool ingest --fast a.txt', 'tool compact -l 3'):
+//
+//     SmpSubcommands commands;
+//     commands.add( "ingest",  runIngest,  "import new records" );   // int runIngest( SmpCommandLine& )
+//     commands.add( "compact", runCompact, "merge the record files" );
+//     return( commands.dispatch( argc, argv ) );
+//
+// dispatch() takes the first unflagged argument as the subcommand name, looks it up in a hash 
+// table, and constructs a SmpCommandLine only for the selected subcommand, over the arguments
+// that follow it. The handler extracts its own arguments and shows its own help, so nothing is
+// paid for the other subcommands. Flags given before the subcommand name are not passed on, and
+// must not take a value (their value would be taken as the subcommand name).
+//-------------------------------------------------------------------------------------------------
+
+class SmpSubcommands 
+{
+  public:
+    typedef std::function<int( SmpCommandLine& )> Handler;
+
+    void add( const char* name, Handler handler, const char* helpMsg = "" );
+
+    // Runs the subcommand named in the command line and returns what its handler returns. Without a
+    // (known) subcommand, the list of subcommands is shown and -1 is returned.
+    int dispatch( int argc, char *const argv[] );
+
+    // Position of the subcommand name in argv after dispatch(), 0 if there was none. Arguments
+    // before it (argv[1] ... ) are global flags.
+    int subcommandIndex() const { return( mSubcommandIndex ); };
+
+    void showHelpMessage();
+
+  protected:
+    struct Subcommand {
+        const char* name;
+        Handler     handler;
+        const char* helpMsg;
+    };
+
+    std::vector<Subcommand>                       mCommands;
+    std::unordered_map<std::string_view, size_t>  mIndex;
+    std::string                                   mProgramName;
+    std::string                                   mScopedName;
+    int                                           mSubcommandIndex = 0;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Options bound to the fields of a config struct:
+//
+//     struct Config { int index; double radius; std::string name; bool bShow; };
+//
+//     SmpOptionBinder<Config> binder;
+//     binder.bind( &Config::index,  "i", "index",  0,      "specifies the index of the item" )
+//           .bind( &Config::radius, "r", "radius", 6750.0, "the radius of the shpere" )
+//           .bind( &Config::name,   "n", "name",   "none", "name of the output" )
+//           .bind( &Config::bShow,  "s", "show",   false,  "whether display the image" );
+//
+//     Config config;
+//     binder.parseInto( userCommands, config );
+//
+// parseInto() walks the token table once, and each flag found is matched through the binder's own
+// hash table; every field is then set by a conversion instantiated for its type (integers, 
+// reals, bool, std::string and std::string_view), straight from the argument text. The order of
+// the bindings does not matter, nor does their order with respect to unflagged arguments: these 
+// are what is left afterwards, see bindPositionals() and SmpCommandLine::positionals(). Bindings 
+// are shown by showHelpMessage(), and take values from the environment and config file layers 
+// like the getters. Flags not bound are left for the getters (e.g. helpMessageWanted()).
+//-------------------------------------------------------------------------------------------------
+
+template< typename Config >
+class SmpOptionBinder 
+{
+  public:
+    // 'defaultValue' is converted to the field type; for string fields it is kept as a pointer, so
+    // pass a string literal (or a string that lives as long as the binder).
+    template< typename T, typename D >
+    SmpOptionBinder& bind( T Config::* field, const char* shortFlag, const char* longFlag, D defaultValue, const char* helpMsg = "" )
+    {
+        static_assert( sizeof(field) <= sizeof(Binding::member), "unsupported pointer to member" );
+
+        Binding binding = Binding();
+        binding.shortFlag = shortFlag;
+        binding.longFlag = longFlag;
+        binding.helpMsg = ( helpMsg != NULL ? helpMsg : "" );
+        memcpy( binding.member, &field, sizeof(field) );
+        binding.store = &storeValue<T>;
+
+        if constexpr( std::is_same<T, bool>::value ) {
+            binding.type = SmpCommandLine::kHelpBoolean;
+            binding.intDefault = ( defaultValue ? 1 : 0 );
+        } else if constexpr( std::is_integral<T>::value ) {
+            binding.type = ( std::is_signed<T>::value ? SmpCommandLine::kHelpInteger : SmpCommandLine::kHelpUnsigned );
+            binding.intDefault = (long long)defaultValue;
+        } else if constexpr( std::is_floating_point<T>::value ) {
+            binding.type = SmpCommandLine::kHelpReal;
+            binding.realDefault = (double)defaultValue;
+        } else {
+            static_assert( std::is_same<T, std::string>::value || std::is_same<T, std::string_view>::value, 
+                           "SmpOptionBinder: unsupported field type" );
+            binding.type = SmpCommandLine::kHelpString;
+            binding.textDefault = std::string_view( defaultValue );
+        }
+
+        if( shortFlag == NULL && longFlag == NULL ) {
+            _ERROR_MESSAGE( "Source usage error: shortFlag and longFlag can not both be NULL!" );
+            return( *this );
+        }
+        mBindings.push_back( binding );
+        indexBinding( mBindings.size() - 1 );
+        return( *this );
+    };
+
+    // The unflagged arguments left after parseInto() are appended to this field, e.g. a 
+    // std::vector<std::string> or std::vector<std::string_view> (views into argv).
+    template< typename Container >
+    SmpOptionBinder& bindPositionals( Container Config::* field )
+    {
+        mPositionals = [field]( Config& config, std::string_view text ) { ( config.*field ).push_back( typename Container::value_type( text ) ); };
+        return( *this );
+    };
+
+    // Sets every bound field of 'config' from 'commandLine' (or its default), consuming the flags 
+    // and values found. Returns false if any value was invalid (its field gets the default then).
+    bool parseInto( SmpCommandLine& commandLine, Config& config ) const
+    {
+        typedef SmpCommandLine::Token Token;
+
+        std::pmr::vector<Token>& tokens = commandLine.tokens;
+        std::pmr::vector<std::string_view> found( mBindings.size(), SmpCommandLine::kNoValue, commandLine.mResource );
+        int n = (int)tokens.size();
+
+        // One pass over the flags still in the token table:
+        for( int i = commandLine.nextUnconsumed( 1 ); i < n; ) 
+        {
+            int b = ( tokens[i].kind == SmpCommandLine::kFlagToken ? findBinding( SmpCommandLine::tokenFlagKey( tokens[i] ) ) : -1 );
+            if( b < 0 ) {
+                i = commandLine.nextUnconsumed( i+1 );
+                continue;
+            }
+
+            commandLine.consumeToken( i );
+            int v = commandLine.nextUnconsumed( i );
+            std::string_view value = SmpCommandLine::kFlagOnlyValue;
+
+            if( mBindings[b].type != SmpCommandLine::kHelpBoolean && v < n && !tokens[v].text.empty() ) {
+                tokens[v].kind = SmpCommandLine::kValueToken;
+                commandLine.consumeToken( v );
+                value = tokens[v].text;
+                v = commandLine.nextUnconsumed( v );
+            }
+            if( found[b].empty() )  // the earlier occurrence wins, as with the getters
+                found[b] = value;
+            i = v;
+        }
+
+        // Every binding, in order: its help item, its value (from a layer if not in the command
+        // line), and the conversion into the field.
+        bool bValid = true;
+        for( size_t b = 0; b < mBindings.size(); b++ ) 
+        {
+            const Binding& binding = mBindings[b];
+            bool bBoolean = ( binding.type == SmpCommandLine::kHelpBoolean );
+
+            SmpCommandLine::HelpItem& item = commandLine.addHelpMessage( binding.shortFlag, binding.longFlag, binding.type, binding.helpMsg );
+            item.bFlagOnly = bBoolean;
+            item.intDefault = binding.intDefault;
+            item.realDefault = binding.realDefault;
+            if( binding.type == SmpCommandLine::kHelpString )
+                commandLine.setHelpText( item, binding.textDefault );
+
+            // A boolean from a layer comes as its text, so that 'false' can override a default of true.
+            std::string_view value = found[b];
+            if( !value.empty() ) {
+                commandLine.recordValueSource( binding.shortFlag, binding.longFlag, SmpCommandLine::kFromCommandLine, value );
+            } else {
+                value = commandLine.getLayeredArgument( binding.shortFlag, binding.longFlag, false );
+            }
+
+            if( !binding.store( binding, config, value ) )
+                bValid = false;
+            if( bBoolean && item.source != SmpCommandLine::kFromDefault )
+                item.value = ( field<bool>( binding, config ) ? SmpCommandLine::kFlagOnlyValue : SmpCommandLine::kNoValue );
+        }
+
+        if( mPositionals ) {
+            for( std::string_view text : commandLine.positionals() ) {
+                mPositionals( config, text );
+            }
+        }
+        return( bValid );
+    };
+
+  protected:
+    struct Binding {
+        const char*                   shortFlag;
+        const char*                   longFlag;
+        const char*                   helpMsg;
+        SmpCommandLine::HelpValueType type;
+        long long                     intDefault;   // bool and integer fields
+        double                        realDefault;
+        std::string_view              textDefault;
+        unsigned char                 member[ sizeof(void*) * 2 ];  // the 'T Config::*' of the field
+        bool (*store)( const Binding&, Config&, std::string_view );
+    };
+
+    std::vector<Binding> mBindings;
+    std::vector<int>     mSlots;   // open-addressing hash: flag -> binding, -1 if empty
+    std::function<void( Config&, std::string_view )> mPositionals;
+
+    template< typename T >
+    static T& field( const Binding& binding, Config& config )
+    {
+        T Config::* member;
+        memcpy( &member, binding.member, sizeof(member) );
+        return( config.*member );
+    };
+
+    // Sets the field from the argument text 'value' (kNoValue when absent: the default is set).
+    // A boolean is true for its flag alone (kFlagOnlyValue), otherwise it is given as text.
+    template< typename T >
+    static bool storeValue( const Binding& binding, Config& config, std::string_view value )
+    {
+        T& target = field<T>( binding, config );
+
+        if constexpr( std::is_same<T, bool>::value ) {
+            target = ( binding.intDefault != 0 );
+            if( value.empty() )
+                return( true );
+            if( value == SmpCommandLine::kFlagOnlyValue ) {
+                target = true;
+                return( true );
+            }
+
+            int errorCode;
+            bool bValue = SmpCommandLine::string2Bool( value, target, &errorCode );
+            if( errorCode == 0 ) {
+                target = bValue;
+                return( true );
+            }
+
+            _ERROR_MESSAGE( "Invalid boolean value '%.*s' for flag %s, ignored.\n", (int)value.size(), value.data(),
+                            ( binding.longFlag != NULL ? binding.longFlag : binding.shortFlag ) );
+            if( SmpCommandLine::bQuitOnError ) {
+                exit(-1);
+            } else {
+                _DEBUG_MESSAGE( "Use default value.\n" );
+                return( false );
+            }
+        } else if constexpr( std::is_arithmetic<T>::value ) {
+            if constexpr( std::is_integral<T>::value )
+                target = (T)binding.intDefault;
+            else
+                target = (T)binding.realDefault;
+            if( value.empty() )
+                return( true );
+
+            T converted = T();
+            SmpConvertResult result = SmpConvert::toNumber( value, converted );
+            if( result.error == kSmpConvertOk ) {
+                target = converted;
+                return( true );
+            }
+
+            _ERROR_MESSAGE( "Invalid number following flag %s in command line: %s at position %d of '%.*s'.\n", 
+                            ( binding.shortFlag != NULL ? binding.shortFlag : binding.longFlag ), SmpConvert::errorString( result.error ),
+                            (int)result.position, (int)value.size(), value.data() );
+            if( SmpCommandLine::bQuitOnError ) {
+                exit(-1);
+            } else { 
+                _DEBUG_MESSAGE( "Use default value.\n" );
+                return( false );
+            }
+        } else {
+            bool bHasValue = !value.empty() && value != SmpCommandLine::kFlagOnlyValue;
+            target = T( bHasValue ? value : binding.textDefault );
+            return( true );
+        }
+    };
+
+    void indexBinding( size_t b )
+    {
+        if( mSlots.size() < mBindings.size() * 4 ) 
+        {
+            // Grow, and insert everything again:
+            mSlots.assign( std::max( (size_t)16, mSlots.size() * 2 ), -1 );
+            for( size_t i = 0; i < mBindings.size(); i++ ) {
+                insertKeys( i );
+            }
+        } else {
+            insertKeys( b );
+        }
+    };
+
+    void insertKeys( size_t b )
+    {
+        const char* flags[2] = { mBindings[b].shortFlag, mBindings[b].longFlag };
+        for( int k = 0; k < 2; k++ ) 
+        {
+            if( flags[k] == NULL )
+                continue;
+            SmpCommandLine::FlagKey key = SmpCommandLine::makeFlagKey( flags[k], k + 1 );
+            size_t mask = mSlots.size() - 1;
+            size_t slot = SmpCommandLine::hashFlag( key ) & mask;
+            while( mSlots[slot] >= 0 ) {
+                slot = ( slot + 1 ) & mask;
+            }
+            mSlots[slot] = (int)b;
+        }
+    };
+
+    int findBinding( const SmpCommandLine::FlagKey& key ) const
+    {
+        if( mSlots.empty() )
+            return( -1 );
+
+        size_t mask = mSlots.size() - 1;
+        for( size_t slot = SmpCommandLine::hashFlag( key ) & mask; mSlots[slot] >= 0; slot = ( slot + 1 ) & mask ) 
+        {
+            const Binding& binding = mBindings[ mSlots[slot] ];
+            const char* flag = ( key.hyphens == 1 ? binding.shortFlag : binding.longFlag );
+            if( flag != NULL && SmpCommandLine::makeFlagKey( flag, key.hyphens ).is( key.hyphens, key.name ) )
+                return( mSlots[slot] );
+        }
+        return( -1 );
+    };
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Compile-time option schema
+//
+// For programs that know their full option set up front, the options can be declared as a 
+// constexpr table and matched through a perfect hash that is generated by the compiler:
+//
+//     static constexpr SmpOption kOptions[] = {
+//         { "i", "index",  kSmpInteger, "0",      "specifies the index of the item" },
+//         { "r", "radius", kSmpReal,    "6750.0", "the radius of the shpere" },
+//         { "s", "show",   kSmpBoolean, "false",  "whether display the image" },
+//     };
+//     static constexpr SmpOptionSchema kSchema( kOptions );
+//     static constexpr int kRadius = kSchema.indexOf( "radius" );
+//
+//     SmpSchemaArgs args = kSchema.parse( argc, argv );
+//     double radius = args.getDouble( kRadius );
+//
+// A long flag is matched with one hash and one compare, a short flag with a table lookup. A short
+// flag of a non-boolean option takes the rest of its token as value when there is one ('-w1920'), 
+// otherwise the next argument. This sits next to SmpCommandLine; it does not replace it.
+//-------------------------------------------------------------------------------------------------
+
+enum SmpOptionType { kSmpInteger = 0, kSmpReal, kSmpString, kSmpBoolean };
+
+struct SmpOption {
+    const char*   shortFlag;    // one letter, with or without the hyphen; NULL if none
+    const char*   longFlag;     // with or without the double hyphen; NULL if none
+    SmpOptionType type;
+    const char*   defaultValue; // textual default, converted like a command line value
+    const char*   helpMsg;
+};
+
+// Called when a perfect hash can not be built. Not constexpr on purpose: reaching it during
+// constant evaluation turns the problem into a compile error.
+inline void smpSchemaError( const char* message )
+{
+    _ERROR_MESSAGE( "%s\n", message );
+    abort();
+}
+
+constexpr size_t smpPow2AtLeast( size_t n )
+{
+    size_t p = 1;
+    while( p < n ) {
+        p *= 2;
+    }
+    return( p );
+}
+
+// Perfect hash over a fixed set of names, built at compile time by "hash and displace": a name is
+// hashed once, the displacement of its bucket selects the slot, and one compare confirms it. With
+// 'IgnoreCase', ASCII letters are folded to lower case for both.
+template< size_t N, bool IgnoreCase = false >
+class SmpPerfectHash 
+{
+  public:
+    static constexpr size_t kTableSize = smpPow2AtLeast( N + N/4 + 1 );
+    static constexpr size_t kBuckets   = N/2 + 1;
+
+    constexpr SmpPerfectHash( const std::array<std::string_view, N>& names ) 
+        : mNames( names ), mSlots(), mDisplacement(), mSeed( 0 )
+    {
+        for( size_t i = 0; i < N; i++ ) {
+            for( size_t j = i+1; j < N; j++ ) {
+                if( !names[i].empty() && equals( names[i], names[j] ) )
+                    smpSchemaError( "SmpPerfectHash: duplicated flag name." );
+            }
+        }
+
+        for( mSeed = 0; mSeed < 64; mSeed++ ) {
+            if( tryBuild() )
+                return;
+        }
+        smpSchemaError( "SmpPerfectHash: can not build a perfect hash for the flag names." );
+    }
+
+    // Returns the index of 'name' in the name list, or -1.
+    constexpr int find( std::string_view name ) const
+    {
+        uint64_t h = hashName( name, mSeed );
+        int k = mSlots[ slotOf( h, mDisplacement[ bucketOf( h ) ] ) ] - 1;
+
+        return( ( k >= 0 && equals( mNames[k], name ) ) ? k : -1 );
+    }
+
+  protected:
+    std::array<std::string_view, N>   mNames;
+    std::array<uint16_t, kTableSize>  mSlots;         // name index + 1, 0 for a free slot
+    std::array<uint16_t, kBuckets>    mDisplacement;
+    uint64_t                          mSeed;
+
+    static constexpr uint64_t hashName( std::string_view name, uint64_t seed )
+    {
+        uint64_t h = 14695981039346656037ull ^ ( seed * 0x9E3779B97F4A7C15ull ); // FNV-1a
+        for( size_t i = 0; i < name.size(); i++ ) {
+            h = ( h ^ (unsigned char)fold( name[i] ) ) * 1099511628211ull;
+        }
+        return( h ^ ( h >> 29 ) );
+    }
+
+    static constexpr char fold( char c )
+    {
+        return( ( IgnoreCase && c >= 'A' && c <= 'Z' ) ? (char)( c - 'A' + 'a' ) : c );
+    }
+
+    static constexpr bool equals( std::string_view a, std::string_view b )
+    {
+        if( a.size() != b.size() )
+            return( false );
+        for( size_t i = 0; i < a.size(); i++ ) {
+            if( fold( a[i] ) != fold( b[i] ) )
+                return( false );
+        }
+        return( true );
+    }
+
+    static constexpr size_t bucketOf( uint64_t h )
+    {
+        return( (size_t)( ( h * 0x9E3779B97F4A7C15ull ) >> 40 ) % kBuckets );
+    }
+
+    static constexpr size_t slotOf( uint64_t h, uint32_t displacement )
+    {
+        uint32_t f = (uint32_t)h;
+        uint32_t g = (uint32_t)( h >> 32 ) | 1;
+        return( ( f + displacement * g ) & ( kTableSize - 1 ) );
+    }
+
+    constexpr bool tryBuild()
+    {
+        std::array<uint64_t, N> hashes = {};
+        std::array<size_t, kBuckets + 1> bucketStart = {};  // keys grouped by bucket in 'members'
+        std::array<size_t, N> members = {};
+        std::array<size_t, kBuckets> order = {};            // buckets, largest first
+        size_t memberCount = 0;
+
+        for( size_t i = 0; i < kTableSize; i++ )  mSlots[i] = 0;
+        for( size_t b = 0; b < kBuckets; b++ )    mDisplacement[b] = 0;
+
+        for( size_t i = 0; i < N; i++ ) {
+            hashes[i] = hashName( mNames[i], mSeed );
+            if( !mNames[i].empty() )
+                bucketStart[ bucketOf( hashes[i] ) + 1 ]++;
+        }
+        for( size_t b = 0; b < kBuckets; b++ ) {
+            bucketStart[b+1] += bucketStart[b];
+        }
+        std::array<size_t, kBuckets> fill = {};
+        for( size_t i = 0; i < N; i++ ) {
+            if( !mNames[i].empty() ) {
+                size_t b = bucketOf( hashes[i] );
+                members[ bucketStart[b] + fill[b]++ ] = i;
+                memberCount++;
+            }
+        }
+        size_t filledBuckets = 0;  // the first entries of 'order'; the rest is unused
+        for( size_t size = memberCount; size > 0; size-- ) {
+            for( size_t b = 0; b < kBuckets; b++ ) {
+                if( bucketStart[b+1] - bucketStart[b] == size ) 
+                    order[filledBuckets++] = b;
+            }
+        }
+
+        // Place the largest buckets first, each with the first displacement that fits:
+        for( size_t k = 0; k < filledBuckets; k++ ) 
+        {
+            size_t b = order[k];
+            size_t first = bucketStart[b];
+            size_t last = bucketStart[b+1];
+
+            bool bPlaced = false;
+            for( uint32_t d = 0; d < kTableSize && !bPlaced; d++ ) 
+            {
+                size_t m = first;
+                while( m < last && mSlots[ slotOf( hashes[ members[m] ], d ) ] == 0 ) {
+                    mSlots[ slotOf( hashes[ members[m] ], d ) ] = (uint16_t)( members[m] + 1 );
+                    m++;
+                }
+                bPlaced = ( m == last );
+
+                if( bPlaced ) {
+                    mDisplacement[b] = (uint16_t)d;
+                } else {
+                    // Roll back the part of the bucket placed with this displacement:
+                    while( m > first ) {
+                        m--;
+                        mSlots[ slotOf( hashes[ members[m] ], d ) ] = 0;
+                    }
+                }
+            }
+            if( !bPlaced )
+                return( false );
+        }
+        return( true );
+    }
+};
+
+// Strips the leading hyphens of a flag given in a SmpOption.
+constexpr std::string_view smpFlagName( const char* flag )
+{
+    std::string_view name( flag != NULL ? flag : "" );
+    while( !name.empty() && name[0] == '-' ) {
+        name.remove_prefix( 1 );
+    }
+    return( name );
+}
+
+// Names and values of an enumerated option, for SmpCommandLine::getChoice():
+//
+//     enum Filter { kGaussian, kBox, kMedian };
+//     static constexpr SmpChoice<Filter> kFilterNames[] = { { "gaussian", kGaussian }, { "box", kBox }, { "median", kMedian } };
+//     static constexpr SmpChoices kFilters( kFilterNames );
+//
+//     Filter filter = userCommands.getChoice( "f", "filter", kFilters, kGaussian, "image filter" );
+//
+// Names are matched ignoring case, through a perfect hash built by the compiler.
+template< typename Enum >
+struct SmpChoice {
+    const char* name;
+    Enum        value;
+};
+
+template< typename Enum, size_t N >
+class SmpChoices 
+{
+  public:
+    constexpr SmpChoices( const SmpChoice<Enum> (&choices)[N] ) 
+        : mHash( names( choices ) ), mNames( names( choices ) ), mValues( values( choices ) )
+    {
+    }
+
+    constexpr size_t size() const { return( N ); }
+
+    constexpr std::string_view name( size_t i ) const { return( mNames[i] ); }
+    constexpr Enum             value( size_t i ) const { return( mValues[i] ); }
+
+    // Index of the choice named 'name' (in any case), or -1.
+    constexpr int find( std::string_view name ) const { return( mHash.find( name ) ); }
+
+    // Index of the (first) choice with 'value', or -1.
+    constexpr int indexOf( Enum value ) const
+    {
+        for( size_t i = 0; i < N; i++ ) {
+            if( mValues[i] == value )
+                return( (int)i );
+        }
+        return( -1 );
+    }
+
+  protected:
+    SmpPerfectHash<N, true>         mHash;
+    std::array<std::string_view, N> mNames;
+    std::array<Enum, N>             mValues;
+
+    static constexpr std::array<std::string_view, N> names( const SmpChoice<Enum> (&choices)[N] )
+    {
+        std::array<std::string_view, N> result = {};
+        for( size_t i = 0; i < N; i++ ) {
+            result[i] = std::string_view( choices[i].name != NULL ? choices[i].name : "" );
+        }
+        return( result );
+    }
+
+    static constexpr std::array<Enum, N> values( const SmpChoice<Enum> (&choices)[N] )
+    {
+        std::array<Enum, N> result = {};
+        for( size_t i = 0; i < N; i++ ) {
+            result[i] = choices[i].value;
+        }
+        return( result );
+    }
+};
+
+template< size_t N > class SmpSchemaArgs;
+
+template< size_t N >
+class SmpOptionSchema 
+{
+  public:
+    constexpr SmpOptionSchema( const SmpOption (&options)[N] ) 
+        : mOptions( toArray( options ) ), mLongHash( longNames( options ) ), mShortIndex()
+    {
+        for( size_t c = 0; c < 128; c++ ) {
+            mShortIndex[c] = -1;
+        }
+        for( size_t i = 0; i < N; i++ ) 
+        {
+            std::string_view name = smpFlagName( options[i].shortFlag );
+            if( name.size() == 1 && (unsigned char)name[0] < 128 ) {
+                if( mShortIndex[ (unsigned char)name[0] ] >= 0 )
+                    smpSchemaError( "SmpOptionSchema: duplicated short flag." );
+                mShortIndex[ (unsigned char)name[0] ] = (int16_t)i;
+            }
+        }
+    }
+
+    constexpr size_t size() const { return( N ); }
+
+    constexpr const SmpOption& operator[]( size_t id ) const { return( mOptions[id] ); }
+
+    // Option id of a long flag name (without hyphens), or -1.
+    constexpr int findLong( std::string_view name ) const { return( mLongHash.find( name ) ); }
+
+    // Option id of a short flag letter, or -1.
+    constexpr int findShort( char letter ) const 
+    { 
+        return( (unsigned char)letter < 128 ? mShortIndex[ (unsigned char)letter ] : -1 ); 
+    }
+
+    // Option id of a flag given as "r", "-r", "radius" or "--radius", or -1.
+    constexpr int indexOf( std::string_view flag ) const
+    {
+        bool bLong = flag.size() > 1 && flag[0] == '-' && flag[1] == '-';
+        while( !flag.empty() && flag[0] == '-' ) {
+            flag.remove_prefix( 1 );
+        }
+        if( flag.size() == 1 && !bLong && findShort( flag[0] ) >= 0 )
+            return( findShort( flag[0] ) );
+        return( findLong( flag ) );
+    }
+
+    SmpSchemaArgs<N> parse( int argc, char *const argv[] ) const
+    {
+        return( SmpSchemaArgs<N>( *this, argc, argv ) );
+    }
+
+  protected:
+    std::array<SmpOption, N> mOptions;
+    SmpPerfectHash<N>        mLongHash;
+    std::array<int16_t, 128> mShortIndex;
+
+    static constexpr std::array<SmpOption, N> toArray( const SmpOption (&options)[N] )
+    {
+        std::array<SmpOption, N> result = {};
+        for( size_t i = 0; i < N; i++ ) {
+            result[i] = options[i];
+        }
+        return( result );
+    }
+
+    static constexpr std::array<std::string_view, N> longNames( const SmpOption (&options)[N] )
+    {
+        std::array<std::string_view, N> names = {};
+        for( size_t i = 0; i < N; i++ ) {
+            names[i] = smpFlagName( options[i].longFlag );
+        }
+        return( names );
+    }
+};
+
+// Result of SmpOptionSchema::parse(): one value slot per option, plus the positional arguments.
+// Values are views into argv.
+template< size_t N >
+class SmpSchemaArgs 
+{
+  public:
+    SmpSchemaArgs( const SmpOptionSchema<N>& schema, int argc, char *const argv[] )
+        : mSchema( &schema )
+    {
+        reparse( argc, argv );
+    };
+
+    // Parses another command line against the same schema, reusing the positional and unknown 
+    // flag vectors: once they are large enough, no allocation is made.
+    void reparse( int argc, char *const argv[] )
+    {
+        parseWords( argc, argv );
+    };
+
+    // Same as above, for a command line already split into words (e.g. by 
+    // SmpSplit::nextShellArgument()), words[0] being the program name.
+    void reparse( int count, const std::string_view words[] )
+    {
+        parseWords( count, words );
+    };
+
+    bool has( size_t id ) const { return( mPresent[id] ); }
+
+    int      getInteger( size_t id ) const { return( convert<int>( id, kSmpInteger ) ); };
+    int64_t  getInt64( size_t id ) const   { return( convert<int64_t>( id, kSmpInteger ) ); };
+    uint64_t getUInt64( size_t id ) const  { return( convert<uint64_t>( id, kSmpInteger ) ); };
+    double   getDouble( size_t id ) const  { return( convert<double>( id, kSmpReal ) ); };
+    float    getFloat( size_t id ) const   { return( convert<float>( id, kSmpReal ) ); };
+
+    std::string_view getString( size_t id ) const { return( valueOf( id, kSmpString ) ); };
+
+    bool getBoolean( size_t id ) const 
+    { 
+        if( mPresent[id] )
+            return( true );
+        const char* defaultValue = (*mSchema)[id].defaultValue;
+        std::string_view text( defaultValue != NULL ? defaultValue : "" );
+        return( text == "true" || text == "1" || text == "yes" || text == "on" );
+    };
+
+    std::string_view programName() const { return( mProgramName ); }
+
+    const std::vector<std::string_view>& positionals() const { return( mPositionals ); }
+
+    const std::vector<std::string_view>& unknownFlags() const { return( mUnknownFlags ); }
+
+  protected:
+    template< size_t M > friend class SmpBatchParser;
+
+    const SmpOptionSchema<N>*       mSchema;
+    std::array<std::string_view, N> mValues;
+    std::array<bool, N>             mPresent;
+    std::string_view                mProgramName;
+    std::vector<std::string_view>   mPositionals;
+    std::vector<std::string_view>   mUnknownFlags;
+
+    // 'argv' is either char* const[] or std::string_view[].
+    template< typename Words >
+    void parseWords( int argc, const Words& argv )
+    {
+        const SmpOptionSchema<N>& schema = *mSchema;
+
+        mValues = std::array<std::string_view, N>();
+        mPresent = std::array<bool, N>();
+        mProgramName = std::string_view();
+        mPositionals.clear();
+        mUnknownFlags.clear();
+
+        if( argc > 0 )
+            mProgramName = argv[0];
+
+        for( int i = 1; i < argc; i++ )
+        {
+            std::string_view arg( argv[i] );
+
+            if( arg.size() > 2 && arg[0] == '-' && arg[1] == '-' ) 
+            {
+                int id = schema.findLong( arg.substr(2) );
+                if( id < 0 ) {
+                    mUnknownFlags.push_back( arg );
+                } else if( schema[id].type == kSmpBoolean ) {
+                    setValue( id, std::string_view(" ") );
+                } else {
+                    setValue( id, i+1 < argc ? std::string_view( argv[++i] ) : std::string_view(" ") );
+                }
+            } 
+            else if( arg.size() > 1 && arg[0] == '-' && isalpha( (unsigned char)arg[1] ) ) 
+            {
+                for( size_t j = 1; j < arg.size(); j++ ) 
+                {
+                    int id = schema.findShort( arg[j] );
+                    if( id < 0 ) {
+                        mUnknownFlags.push_back( arg );
+                        break;
+                    } else if( schema[id].type == kSmpBoolean ) {
+                        setValue( id, std::string_view(" ") );
+                    } else {
+                        if( j+1 < arg.size() ) 
+                            setValue( id, arg.substr( j+1 ) );
+                        else 
+                            setValue( id, i+1 < argc ? std::string_view( argv[++i] ) : std::string_view(" ") );
+                        break;
+                    }
+                }
+            } 
+            else 
+            {
+                mPositionals.push_back( arg );
+            }
+        }
+    };
+    void setValue( int id, std::string_view value )
+    {
+        mValues[id] = value;
+        mPresent[id] = true;
+    };
+
+    // Value text of option 'id', or its default when absent.
+    std::string_view valueOf( size_t id, SmpOptionType type ) const
+    {
+        const SmpOption& option = (*mSchema)[id];
+
+        if( option.type != type && !( option.type == kSmpInteger && type == kSmpReal ) ) {
+            _ERROR_MESSAGE( "Option %s is not declared with the requested type.\n", 
+                            option.longFlag != NULL ? option.longFlag : option.shortFlag );
+        }
+
+        if( !mPresent[id] || mValues[id] == " " ) 
+            return( std::string_view( option.defaultValue != NULL ? option.defaultValue : "" ) );
+
+        return( mValues[id] );
+    };
+
+    template< typename T >
+    T convert( size_t id, SmpOptionType type ) const
+    {
+        std::string_view text = valueOf( id, type );
+        T value = T();
+        SmpConvertResult result = SmpConvert::toNumber( text, value );
+
+        if( result.error != kSmpConvertOk && mPresent[id] ) 
+        {
+            const SmpOption& option = (*mSchema)[id];
+            _ERROR_MESSAGE( "Invalid number following flag %s in command line: %s at position %d of '%.*s'.\n", 
+                            option.longFlag != NULL ? option.longFlag : option.shortFlag, 
+                            SmpConvert::errorString( result.error ), (int)result.position, 
+                            (int)text.size(), text.data() );
+            _DEBUG_MESSAGE( "Use default value.\n" );
+            value = T();
+            SmpConvert::toNumber( std::string_view( option.defaultValue != NULL ? option.defaultValue : "" ), value );
+        }
+        return( value );
+    };
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Batch parsing of job manifests: one command line per line, millions of lines, one schema.
+//
+//     SmpBatchParser<3> parser( kSchema );                  // all cores; or ( kSchema, threads )
+//     SmpBatchResult<3> jobs = parser.parseFile( "manifest.txt" );
+//     const double* radius = jobs.reals( kRadius );         // one value per line
+//     for( const SmpBatchError& e : jobs.errors() ) ...     // sorted by line
+//
+// The manifest is mapped, cut into chunks of whole lines, and the chunks are claimed by the worker
+// threads one at a time from an atomic counter, so that a thread done early takes over the rest.
+// A first pass counts the lines per chunk (vectorized), a second one splits every line as a shell
+// would (SmpSplit::nextShellArgument(), the first word being the program name), matches it with
+// SmpSchemaArgs and converts the values straight into columns: one array per option, indexed by
+// line. Lines are counted from 0 in the columns, and from 1 in the errors. Invalid values are not
+// reported on stdout but recorded as SmpBatchError, and the option's default is stored instead.
+// Strings and positional arguments are views into the mapping, which the result keeps alive.
+//-------------------------------------------------------------------------------------------------
+
+enum SmpBatchErrorCode { kSmpBatchUnknownFlag = 1, kSmpBatchMissingValue, kSmpBatchInvalidValue, kSmpBatchUnterminatedQuote };
+
+struct SmpBatchError 
+{
+    size_t            line;        // counted from 1
+    int               option;      // schema id, -1 for an unknown flag
+    SmpBatchErrorCode code;
+    SmpConvertError   convertError; // for kSmpBatchInvalidValue
+    std::string_view  text;        // the unknown flag, the invalid value, or the argument left 
+                                   // unterminated (dropped; the words before it are parsed)
+};
+
+template< size_t N >
+class SmpBatchResult 
+{
+  public:
+    bool   valid() const     { return( mbValid ); };
+    size_t lineCount() const { return( mLineCount ); };
+
+    // Columns of option 'id', one value per line. Each option has the column of its type only:
+    // integers() for kSmpInteger, reals() for kSmpReal, strings() for kSmpString, and booleans()
+    // for kSmpBoolean; present() exists for all, 1 where the line gave the option.
+    const int64_t*          integers( size_t id ) const { return( mColumns[id].integers.data() ); };
+    const double*           reals( size_t id ) const    { return( mColumns[id].reals.data() ); };
+    const std::string_view* strings( size_t id ) const  { return( mColumns[id].strings.data() ); };
+    const uint8_t*          booleans( size_t id ) const { return( mColumns[id].booleans.data() ); };
+    const uint8_t*          present( size_t id ) const  { return( mColumns[id].present.data() ); };
+
+    std::string_view programName( size_t line ) const { return( mProgramNames[line] ); };
+
+    size_t positionalCount( size_t line ) const 
+    { 
+        return( mPositionalStart[line+1] - mPositionalStart[line] ); 
+    };
+
+    std::string_view positional( size_t line, size_t k ) const 
+    { 
+        return( mPositionals[ mPositionalStart[line] + k ] ); 
+    };
+
+    const std::vector<SmpBatchError>& errors() const { return( mErrors ); };
+
+  protected:
+    template< size_t M > friend class SmpBatchParser;
+
+    struct Column {
+        std::vector<int64_t>          integers;
+        std::vector<double>           reals;
+        std::vector<std::string_view> strings;
+        std::vector<uint8_t>          booleans;
+        std::vector<uint8_t>          present;
+    };
+
+    bool                           mbValid = false;
+    size_t                         mLineCount = 0;
+    std::array<Column, N>          mColumns;
+    std::vector<std::string_view>  mProgramNames;
+    std::vector<std::string_view>  mPositionals;
+    std::vector<size_t>            mPositionalStart; // lineCount + 1 entries
+    std::vector<SmpBatchError>     mErrors;
+    std::shared_ptr<SmpMappedFile> mFile;
+};
+
+template< size_t N >
+class SmpBatchParser 
+{
+  public:
+    // 'threadCount' 0 uses all hardware threads. 'chunkBytes' is the unit of work claimed at once.
+    explicit SmpBatchParser( const SmpOptionSchema<N>& schema, unsigned threadCount = 0, size_t chunkBytes = 256u << 10 )
+        : mSchema( &schema ), mThreadCount( threadCount ), mChunkBytes( std::max( chunkBytes, (size_t)1 ) )
+    {
+        if( mThreadCount == 0 )
+            mThreadCount = std::max( std::thread::hardware_concurrency(), 1u );
+
+        // Defaults are converted once, here:
+        for( size_t id = 0; id < N; id++ ) 
+        {
+            const SmpOption& option = schema[id];
+            std::string_view text( option.defaultValue != NULL ? option.defaultValue : "" );
+            mDefaultText[id] = text;
+            mDefaultInteger[id] = 0;
+            mDefaultReal[id] = 0.0;
+            SmpConvert::toNumber( text, mDefaultInteger[id] );
+            SmpConvert::toNumber( text, mDefaultReal[id] );
+            mDefaultBoolean[id] = ( text == "true" || text == "1" || text == "yes" || text == "on" );
+        }
+    };
+
+    // Maps the manifest 'path' (privately: quoted arguments are unquoted in place) and parses it.
+    // The result is invalid (see valid()) if the file can not be read.
+    SmpBatchResult<N> parseFile( const char* path, size_t maxBytes = (size_t)-1 ) const
+    {
+        SmpBatchResult<N> result;
+        result.mFile = std::make_shared<SmpMappedFile>();
+        if( result.mFile->open( path, maxBytes ) != SmpMappedFile::kOpenOk ) {
+            _ERROR_MESSAGE( "Manifest %s can not be read.\n", path );
+            return( result );
+        }
+        parseInto( result.mFile->data(), result.mFile->size(), result );
+        return( result );
+    };
+
+    // Same as above, for a manifest already in memory. Quoted arguments are unquoted in place, so
+    // 'text' is modified, and it has to outlive the result.
+    SmpBatchResult<N> parse( char* text, size_t size ) const
+    {
+        SmpBatchResult<N> result;
+        parseInto( text, size, result );
+        return( result );
+    };
+
+  protected:
+    const SmpOptionSchema<N>*       mSchema;
+    unsigned                        mThreadCount;
+    size_t                          mChunkBytes;
+    std::array<std::string_view, N> mDefaultText;
+    std::array<int64_t, N>          mDefaultInteger;
+    std::array<double, N>           mDefaultReal;
+    std::array<bool, N>             mDefaultBoolean;
+
+    // A range of whole lines, and what parsing it produced besides the columns.
+    struct Chunk {
+        size_t                        begin;
+        size_t                        end;
+        size_t                        firstLine;
+        size_t                        lineCount;
+        std::vector<std::string_view> positionals;
+        std::vector<size_t>           positionalEnd; // per line, relative to the chunk
+        std::vector<SmpBatchError>    errors;
+    };
+
+    // Runs 'work( chunkIndex )' for every chunk, on up to mThreadCount threads claiming chunks
+    // from a shared counter.
+    template< typename Work >
+    void forEachChunk( size_t chunkCount, const Work& work ) const
+    {
+        std::atomic<size_t> next( 0 );
+        auto worker = [&]() {
+            for( size_t c = next.fetch_add( 1 ); c < chunkCount; c = next.fetch_add( 1 ) ) {
+                work( c );
+            }
+        };
+
+        size_t threadCount = std::min( (size_t)mThreadCount, chunkCount );
+        std::vector<std::thread> threads;
+        for( size_t t = 1; t < threadCount; t++ ) {
+            threads.emplace_back( worker );
+        }
+        worker();
+        for( size_t t = 0; t < threads.size(); t++ ) {
+            threads[t].join();
+        }
+    };
+
+    void parseInto( char* text, size_t size, SmpBatchResult<N>& result ) const
+    {
+        std::string_view all( text, size );
+
+        // Chunk boundaries, moved forward to the next line start:
+        std::vector<Chunk> chunks;
+        for( size_t begin = 0; begin < size; ) 
+        {
+            size_t end = std::min( begin + mChunkBytes, size );
+            if( end < size )
+                end = std::min( SmpSplit::find( all, end, '\n' ) + 1, size );
+            chunks.emplace_back();
+            chunks.back().begin = begin;
+            chunks.back().end = end;
+            begin = end;
+        }
+
+        // Pass 1: lines per chunk, and the first line of each.
+        forEachChunk( chunks.size(), [&]( size_t c ) {
+            Chunk& chunk = chunks[c];
+            std::string_view range = all.substr( chunk.begin, chunk.end - chunk.begin );
+            chunk.lineCount = SmpSplit::count( range, '\n' ) + ( range.back() != '\n' ? 1 : 0 );
+        } );
+
+        size_t lineCount = 0;
+        for( size_t c = 0; c < chunks.size(); c++ ) {
+            chunks[c].firstLine = lineCount;
+            lineCount += chunks[c].lineCount;
+        }
+
+        result.mLineCount = lineCount;
+        result.mProgramNames.assign( lineCount, std::string_view() );
+        for( size_t id = 0; id < N; id++ ) 
+        {
+            typename SmpBatchResult<N>::Column& column = result.mColumns[id];
+            column.present.assign( lineCount, 0 );
+            switch( (*mSchema)[id].type ) 
+            {
+              case kSmpInteger: column.integers.assign( lineCount, 0 ); break;
+              case kSmpReal:    column.reals.assign( lineCount, 0.0 ); break;
+              case kSmpString:  column.strings.assign( lineCount, std::string_view() ); break;
+              default:          column.booleans.assign( lineCount, 0 ); break;
+            }
+        }
+
+        // Pass 2: every line into the columns; the word list and matcher are reused within a chunk.
+        forEachChunk( chunks.size(), [&]( size_t c ) {
+            std::vector<std::string_view> words;
+            SmpSchemaArgs<N> args( *mSchema, 0, NULL );
+            Chunk& chunk = chunks[c];
+
+            size_t line = chunk.firstLine;
+            for( size_t begin = chunk.begin; begin < chunk.end; line++ ) 
+            {
+                size_t end = SmpSplit::find( all.substr( 0, chunk.end ), begin, '\n' );
+                size_t lineEnd = ( end > begin && text[end-1] == '\r' ) ? end - 1 : end;
+
+                words.clear();
+                size_t pos = begin;
+                std::string_view word;
+                int shellStatus;
+                while( ( shellStatus = SmpSplit::nextShellArgument( text, lineEnd, pos, text + pos, word ) ) == SmpSplit::kShellArgument ) {
+                    words.push_back( word );
+                }
+
+                args.reparse( (int)words.size(), words.data() );
+                storeLine( args, line, chunk, result );
+                if( shellStatus == SmpSplit::kShellUnterminated )
+                    addError( chunk, line, -1, kSmpBatchUnterminatedQuote, kSmpConvertOk, word );
+                begin = end + 1;
+            }
+        } );
+
+        // Positional arguments and errors, concatenated in line order:
+        size_t positionalCount = 0;
+        size_t errorCount = 0;
+        for( size_t c = 0; c < chunks.size(); c++ ) {
+            positionalCount += chunks[c].positionals.size();
+            errorCount += chunks[c].errors.size();
+        }
+        result.mPositionals.reserve( positionalCount );
+        result.mPositionalStart.reserve( lineCount + 1 );
+        result.mErrors.reserve( errorCount );
+        result.mPositionalStart.push_back( 0 );
+
+        for( size_t c = 0; c < chunks.size(); c++ ) 
+        {
+            size_t base = result.mPositionals.size();
+            result.mPositionals.insert( result.mPositionals.end(), chunks[c].positionals.begin(), chunks[c].positionals.end() );
+            for( size_t k = 0; k < chunks[c].positionalEnd.size(); k++ ) {
+                result.mPositionalStart.push_back( base + chunks[c].positionalEnd[k] );
+            }
+            result.mErrors.insert( result.mErrors.end(), chunks[c].errors.begin(), chunks[c].errors.end() );
+        }
+        result.mbValid = true;
+    };
+
+    void storeLine( const SmpSchemaArgs<N>& args, size_t line, Chunk& chunk, SmpBatchResult<N>& result ) const
+    {
+        result.mProgramNames[line] = args.mProgramName;
+
+        for( size_t id = 0; id < N; id++ ) 
+        {
+            typename SmpBatchResult<N>::Column& column = result.mColumns[id];
+            SmpOptionType type = (*mSchema)[id].type;
+            bool bPresent = args.mPresent[id];
+            std::string_view text = args.mValues[id];
+
+            column.present[line] = bPresent;
+            if( bPresent && text == " " && type != kSmpBoolean ) {
+                addError( chunk, line, (int)id, kSmpBatchMissingValue, kSmpConvertOk, kNoText );
+                bPresent = false;
+            }
+
+            SmpConvertResult converted = { kSmpConvertOk, 0 };
+            switch( type ) 
+            {
+              case kSmpInteger:
+                column.integers[line] = mDefaultInteger[id];
+                if( bPresent && ( converted = SmpConvert::toNumber( text, column.integers[line] ) ).error != kSmpConvertOk )
+                    column.integers[line] = mDefaultInteger[id];
+                break;
+              case kSmpReal:
+                column.reals[line] = mDefaultReal[id];
+                if( bPresent && ( converted = SmpConvert::toNumber( text, column.reals[line] ) ).error != kSmpConvertOk )
+                    column.reals[line] = mDefaultReal[id];
+                break;
+              case kSmpString:
+                column.strings[line] = ( bPresent ? text : mDefaultText[id] );
+                break;
+              default:
+                column.booleans[line] = ( bPresent || mDefaultBoolean[id] );
+                break;
+            }
+            if( converted.error != kSmpConvertOk )
+                addError( chunk, line, (int)id, kSmpBatchInvalidValue, converted.error, text );
+        }
+
+        for( size_t k = 0; k < args.mUnknownFlags.size(); k++ ) {
+            addError( chunk, line, -1, kSmpBatchUnknownFlag, kSmpConvertOk, args.mUnknownFlags[k] );
+        }
+
+        chunk.positionals.insert( chunk.positionals.end(), args.mPositionals.begin(), args.mPositionals.end() );
+        chunk.positionalEnd.push_back( chunk.positionals.size() );
+    };
+
+    static constexpr std::string_view kNoText = std::string_view();
+
+    static void addError( Chunk& chunk, size_t line, int option, SmpBatchErrorCode code, SmpConvertError convertError, std::string_view text )
+    {
+        SmpBatchError error;
+        error.line = line + 1;
+        error.option = option;
+        error.code = code;
+        error.convertError = convertError;
+        error.text = text;
+        chunk.errors.push_back( error );
+    };
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Out-of-line members of SmpMappedFile, SmpParsedArgs, SmpCommandLine and SmpSubcommands. By 
+// default they are defined inline right here, and the header is all a program needs. With 
+// SMP_PREBUILT defined, the header only declares them: they are compiled once, by 
+// SmpCommandLine.cpp (which defines SMP_IMPLEMENTATION), into the static library built with the
+// SMP_PREBUILT_LIBRARY option of CMakeLists.txt.
+//-------------------------------------------------------------------------------------------------
+
+#if !defined(SMP_PREBUILT) || defined(SMP_IMPLEMENTATION)
+
+
+// SmpMappedFile:
+
+SMP_INLINE int SmpMappedFile::open( const char* path, size_t maxBytes )
+{
+    close();
+#if defined(SMP_HAS_MMAP)
+    int fd = ::open( path, O_RDONLY );
+    if( fd < 0 )
+        return( kOpenFailed );
+
+    struct stat info;
+    if( fstat( fd, &info ) != 0 || !S_ISREG( info.st_mode ) ) {
+        ::close( fd );
+        return( kOpenFailed );
+    }
+    if( (unsigned long long)info.st_size > maxBytes ) {
+        ::close( fd );
+        return( kOpenTooLarge );
+    }
+
+    mSize = (size_t)info.st_size;
+    if( mSize > 0 ) {
+        void* p = mmap( NULL, mSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+        if( p == MAP_FAILED ) {
+            ::close( fd );
+            mSize = 0;
+            return( kOpenFailed );
+        }
+        mData = (char*)p;
+        mbMapped = true;
+    }
+    ::close( fd );
+#else
+    FILE* file = fopen( path, "rb" );
+    if( file == NULL )
+        return( kOpenFailed );
+
+    fseek( file, 0, SEEK_END );
+    long size = ftell( file );
+    fseek( file, 0, SEEK_SET );
+    if( size < 0 || (unsigned long)size > maxBytes ) {
+        fclose( file );
+        return( size < 0 ? kOpenFailed : kOpenTooLarge );
+    }
+
+    mSize = (size_t)size;
+    mData = new char[ mSize + 1 ];
+    mSize = fread( mData, 1, mSize, file );
+    fclose( file );
+#endif
+    return( kOpenOk );
+}
+
+SMP_INLINE void SmpMappedFile::close()
+{
+#if defined(SMP_HAS_MMAP)
+    if( mbMapped )
+        munmap( mData, mSize );
+#else
+    delete[] mData;
+#endif
+    mData = NULL;
+    mSize = 0;
+    mbMapped = false;
+}
+
+
+// SmpParsedArgs:
+
+SMP_INLINE int SmpParsedArgs::writeSnapshot() const
+{
+#if defined(SMP_HAS_MMAP)
+    if( mBase == NULL )
+        return( -1 );
+
+  #if defined(__linux__) && defined(MFD_ALLOW_SEALING)
+    int fd = memfd_create( "SmpParsedArgs", MFD_ALLOW_SEALING );
+  #else
+    char path[] = "/tmp/SmpParsedArgs_XXXXXX";
+    int fd = mkstemp( path );
+    if( fd >= 0 )
+        unlink( path );
+  #endif
+    if( fd < 0 ) {
+        _ERROR_MESSAGE( "Snapshot file can not be created (errno %d).\n", errno );
+        return( -1 );
+    }
+
+    for( size_t written = 0; written < mSize; ) 
+    {
+        ssize_t n = write( fd, mBase + written, mSize - written );
+        if( n < 0 && errno == EINTR )
+            continue;
+        if( n <= 0 ) {
+            _ERROR_MESSAGE( "Snapshot can not be written (errno %d).\n", errno );
+            ::close( fd );
+            return( -1 );
+        }
+        written += (size_t)n;
+    }
+
+  #if defined(F_ADD_SEALS) && defined(F_SEAL_WRITE)
+    fcntl( fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL );
+  #endif
+    return( fd );
+#else
+    _ERROR_MESSAGE( "Snapshots are not supported on this platform.\n" );
+    return( -1 );
+#endif
+}
+
+SMP_INLINE SmpParsedArgs SmpParsedArgs::fromSnapshot( int fd )
+{
+#if defined(SMP_HAS_MMAP)
+    struct stat info;
+    if( fd < 0 || fstat( fd, &info ) != 0 || (size_t)info.st_size < sizeof(Header) ) {
+        _ERROR_MESSAGE( "Snapshot file descriptor %d can not be read.\n", fd );
+        return( SmpParsedArgs() );
+    }
+
+    size_t size = (size_t)info.st_size;
+    void* p = mmap( NULL, size, PROT_READ, MAP_SHARED, fd, 0 );
+    if( p == MAP_FAILED ) {
+        _ERROR_MESSAGE( "Snapshot file descriptor %d can not be mapped (errno %d).\n", fd, errno );
+        return( SmpParsedArgs() );
+    }
+
+    std::shared_ptr<const void> holder( p, [size]( const void* q ) { munmap( (void*)q, size ); } );
+    if( !isValidBuffer( (const char*)p, size ) ) {
+        _ERROR_MESSAGE( "File descriptor %d holds no valid snapshot (version %u expected).\n", fd, kVersion );
+        return( SmpParsedArgs() );
+    }
+    return( SmpParsedArgs( holder, (const char*)p, ( (const Header*)p )->size ) );
+#else
+    (void)fd;
+    _ERROR_MESSAGE( "Snapshots are not supported on this platform.\n" );
+    return( SmpParsedArgs() );
+#endif
+}
+
+SMP_INLINE bool SmpParsedArgs::isValidBuffer( const char* base, size_t size )
+{
+    if( base == NULL || ( (uintptr_t)base & 7 ) != 0 || size < sizeof(Header) )
+        return( false );
+
+    const Header& h = *(const Header*)base;
+    if( h.magic != kMagic || h.version != kVersion || h.size > size || h.poolOffset > h.size )
+        return( false );
+    if( h.slotCount == 0 || ( h.slotCount & ( h.slotCount - 1 ) ) != 0 || h.entryCount >= h.slotCount )
+        return( false );
+    if( (uint64_t)h.entriesOffset + (uint64_t)h.entryCount * sizeof(Entry) > h.poolOffset ||
+        (uint64_t)h.slotsOffset + (uint64_t)h.slotCount * sizeof(uint32_t) > h.poolOffset ||
+        (uint64_t)h.positionalsOffset + (uint64_t)h.positionalCount * sizeof(Span) > h.poolOffset ||
+        ( ( h.entriesOffset | h.slotsOffset | h.positionalsOffset ) & 7 ) != 0 )
+        return( false );
+
+    uint64_t poolSize = h.size - h.poolOffset;
+    const Entry* entries = (const Entry*)( base + h.entriesOffset );
+    const uint32_t* slots = (const uint32_t*)( base + h.slotsOffset );
+    const Span* spans = (const Span*)( base + h.positionalsOffset );
+
+    for( uint32_t i = 0; i < h.entryCount; i++ ) {
+        if( (uint64_t)entries[i].nameOffset + entries[i].nameLength > poolSize || 
+            (uint64_t)entries[i].textOffset + entries[i].textLength > poolSize )
+            return( false );
+    }
+    // An empty slot ends every probe sequence in findEntry():
+    uint32_t emptySlots = 0;
+    for( uint32_t i = 0; i < h.slotCount; i++ ) {
+        if( slots[i] > h.entryCount )
+            return( false );
+        emptySlots += ( slots[i] == 0 );
+    }
+    if( emptySlots == 0 )
+        return( false );
+    for( uint32_t i = 0; i < h.positionalCount; i++ ) {
+        if( (uint64_t)spans[i].offset + spans[i].length > poolSize )
+            return( false );
+    }
+    return( (uint64_t)h.programOffset + h.programLength <= poolSize );
+}
+
+SMP_INLINE const SmpParsedArgs::Entry* SmpParsedArgs::findEntry( const char* flag ) const
+{
+    if( mBase == NULL || flag == NULL || header()->slotCount == 0 )
+        return( NULL );
+
+    std::string_view name( flag );
+    int hyphens = 0;
+    while( hyphens < 2 && !name.empty() && name[0] == '-' ) {
+        name.remove_prefix( 1 );
+        hyphens++;
+    }
+    if( hyphens == 0 )
+        hyphens = ( name.size() == 1 ? 1 : 2 );
+
+    uint32_t mask = header()->slotCount - 1;
+    uint32_t slot = hashKey( hyphens, name ) & mask;
+    for( uint32_t probes = 0; probes < header()->slotCount && slots()[slot] != 0; probes++, slot = ( slot + 1 ) & mask )
+    {
+        const Entry* entry = &entries()[ slots()[slot] - 1 ];
+        if( entry->hyphens == hyphens && text( entry->nameOffset, entry->nameLength ) == name )
+            return( entry );
+    }
+    return( NULL );
+}
+
+
+// SmpCommandLine:
+
+SMP_INLINE SmpCommandLine::SmpCommandLine( int argc, char *const argv[], size_t maxResponseFileBytes )
+    : SmpCommandLine( argc, argv, (std::pmr::memory_resource*)NULL, maxResponseFileBytes )
+{
+}
+
+SMP_INLINE SmpCommandLine::SmpCommandLine( int argc, char *const argv[], std::pmr::memory_resource* resource, 
+                                           size_t maxResponseFileBytes )
+    : mResource( resource != NULL ? resource : defaultResource() ), tokens( mResource ), flagIndex( mResource ), 
+      helpItems( mResource ), helpTextPool( mResource ), responseFiles( mResource ), configFiles( mResource ), 
+      configEntries( mResource ), configIndex( mResource ), mEnvironmentPrefix( mResource ), mDiagnostics( mResource )
+{
+    mMaxResponseFileBytes = maxResponseFileBytes;
+    parse( argc, argv );
+
+    ////
+    // Debug: show the final (splited) argument list:
+    //_DEBUG_MESSAGE( "List of argumanets:\n" );
+    //for( int i = 0; i < tokens.size(); i++ ) 
+    //{
+    //    _DEBUG_MESSAGE( "\t%.*s\n", (int)tokens[i].text.size(), tokens[i].text.data() );
+    //}
+}
+
+SMP_INLINE SmpCommandLine::SmpCommandLine( std::string_view commandLine, size_t maxResponseFileBytes )
+    : SmpCommandLine( commandLine, (std::pmr::memory_resource*)NULL, maxResponseFileBytes )
+{
+}
+
+SMP_INLINE SmpCommandLine::SmpCommandLine( std::string_view commandLine, std::pmr::memory_resource* resource, 
+                                           size_t maxResponseFileBytes )
+    : SmpCommandLine( 0, NULL, resource, maxResponseFileBytes )
+{
+    parse( commandLine );
+}
+
+SMP_INLINE int SmpCommandLine::getInteger( const char* shortFlag, const char* longFlag, int defaultValue, const char* helpMsg )
+{
+    addHelpMessage( shortFlag, longFlag, kHelpInteger, helpMsg ).intDefault = defaultValue;
+
+    return( convertFlagged( shortFlag, longFlag, defaultValue ) );
+}
+
+SMP_INLINE int SmpCommandLine::getInteger( int index, int defaultValue, const char* helpMsg )
+{   
+    addHelpMessage( index, kHelpInteger, helpMsg ).intDefault = defaultValue;
+    
+    return( convertUnflagged( index, defaultValue ) );
+}
+
+SMP_INLINE float SmpCommandLine::getFloat( const char* shortFlag, const char* longFlag, float defaultValue, const char* helpMsg )
+{
+    addHelpMessage( shortFlag, longFlag, kHelpReal, helpMsg ).realDefault = defaultValue;
+
+    return( convertFlagged( shortFlag, longFlag, defaultValue ) );
+}
+
+SMP_INLINE float SmpCommandLine::getFloat( int index, float defaultValue, const char* helpMsg )
+{   
+    addHelpMessage( index, kHelpReal, helpMsg ).realDefault = defaultValue;
+    
+    return( convertUnflagged( index, defaultValue ) );
+}
+
+SMP_INLINE double SmpCommandLine::getDouble( const char* shortFlag, const char* longFlag, double defaultValue, const char* helpMsg )
+{
+    addHelpMessage( shortFlag, longFlag, kHelpReal, helpMsg ).realDefault = defaultValue;
+
+    return( convertFlagged( shortFlag, longFlag, defaultValue ) );
+}
+
+SMP_INLINE double SmpCommandLine::getDouble( int index, double defaultValue, const char* helpMsg )
+{   
+    addHelpMessage( index, kHelpReal, helpMsg ).realDefault = defaultValue;
+    
+    return( convertUnflagged( index, defaultValue ) );
+}
+
+SMP_INLINE int64_t SmpCommandLine::getInt64( const char* shortFlag, const char* longFlag, int64_t defaultValue, const char* helpMsg )
+{
+    addHelpMessage( shortFlag, longFlag, kHelpInteger, helpMsg ).intDefault = defaultValue;
+
+    return( convertFlagged( shortFlag, longFlag, defaultValue ) );
+}
+
+SMP_INLINE int64_t SmpCommandLine::getInt64( int index, int64_t defaultValue, const char* helpMsg )
+{   
+    addHelpMessage( index, kHelpInteger, helpMsg ).intDefault = defaultValue;
+    
+    return( convertUnflagged( index, defaultValue ) );
+}
+
+SMP_INLINE uint64_t SmpCommandLine::getUInt64( const char* shortFlag, const char* longFlag, uint64_t defaultValue, const char* helpMsg )
+{
+    addHelpMessage( shortFlag, longFlag, kHelpUnsigned, helpMsg ).intDefault = (long long)defaultValue;
+
+    return( convertFlagged( shortFlag, longFlag, defaultValue ) );
+}
+
+SMP_INLINE uint64_t SmpCommandLine::getUInt64( int index, uint64_t defaultValue, const char* helpMsg )
+{   
+    addHelpMessage( index, kHelpUnsigned, helpMsg ).intDefault = (long long)defaultValue;
+    
+    return( convertUnflagged( index, defaultValue ) );
+}
+
+SMP_INLINE size_t SmpCommandLine::getSize( const char* shortFlag, const char* longFlag, size_t defaultValue, const char* helpMsg )
+{
+    addHelpMessage( shortFlag, longFlag, kHelpUnsigned, helpMsg ).intDefault = (long long)defaultValue;
+
+    return( convertFlagged( shortFlag, longFlag, defaultValue ) );
+}
+
+SMP_INLINE size_t SmpCommandLine::getSize( int index, size_t defaultValue, const char* helpMsg )
+{   
+    addHelpMessage( index, kHelpUnsigned, helpMsg ).intDefault = (long long)defaultValue;
+    
+    return( convertUnflagged( index, defaultValue ) );
+}
+
+SMP_INLINE std::chrono::nanoseconds SmpCommandLine::getDuration( const char* shortFlag, const char* longFlag, 
+                                                                 std::chrono::nanoseconds defaultValue, const char* helpMsg )
+{
+    addHelpMessage( shortFlag, longFlag, kHelpDuration, helpMsg ).intDefault = (long long)defaultValue.count();
+
+    return( std::chrono::nanoseconds( (int64_t)convertWithUnit( getFlaggedArgument( shortFlag, longFlag ), SmpUnits::kDuration, 
+                                                                (uint64_t)std::numeric_limits<int64_t>::max(), 
+                                                                (uint64_t)defaultValue.count(), (shortFlag!=NULL? shortFlag:longFlag), 0 ) ) );
+}
+
+SMP_INLINE std::chrono::nanoseconds SmpCommandLine::getDuration( int index, std::chrono::nanoseconds defaultValue, const char* helpMsg )
+{
+    addHelpMessage( index, kHelpDuration, helpMsg ).intDefault = (long long)defaultValue.count();
+
+    return( std::chrono::nanoseconds( (int64_t)convertWithUnit( getUnflaggedArgument( index ), SmpUnits::kDuration, 
+                                                                (uint64_t)std::numeric_limits<int64_t>::max(), 
+                                                                (uint64_t)defaultValue.count(), NULL, index ) ) );
+}
+
+SMP_INLINE uint64_t SmpCommandLine::getBytes( const char* shortFlag, const char* longFlag, uint64_t defaultValue, const char* helpMsg )
+{
+    addHelpMessage( shortFlag, longFlag, kHelpBytes, helpMsg ).intDefault = (long long)defaultValue;
+
+    return( convertWithUnit( getFlaggedArgument( shortFlag, longFlag ), SmpUnits::kBytes, std::numeric_limits<uint64_t>::max(), 
+                             defaultValue, (shortFlag!=NULL? shortFlag:longFlag), 0 ) );
+}
+
+SMP_INLINE uint64_t SmpCommandLine::getBytes( int index, uint64_t defaultValue, const char* helpMsg )
+{
+    addHelpMessage( index, kHelpBytes, helpMsg ).intDefault = (long long)defaultValue;
+
+    return( convertWithUnit( getUnflaggedArgument( index ), SmpUnits::kBytes, std::numeric_limits<uint64_t>::max(), 
+                             defaultValue, NULL, index ) );
+}
+
+SMP_INLINE uint64_t SmpCommandLine::getCount( const char* shortFlag, const char* longFlag, uint64_t defaultValue, const char* helpMsg )
+{
+    addHelpMessage( shortFlag, longFlag, kHelpCount, helpMsg ).intDefault = (long long)defaultValue;
+
+    return( convertWithUnit( getFlaggedArgument( shortFlag, longFlag ), SmpUnits::kCount, std::numeric_limits<uint64_t>::max(), 
+                             defaultValue, (shortFlag!=NULL? shortFlag:longFlag), 0 ) );
+}
+
+SMP_INLINE uint64_t SmpCommandLine::getCount( int index, uint64_t defaultValue, const char* helpMsg )
+{
+    addHelpMessage( index, kHelpCount, helpMsg ).intDefault = (long long)defaultValue;
+
+    return( convertWithUnit( getUnflaggedArgument( index ), SmpUnits::kCount, std::numeric_limits<uint64_t>::max(), 
+                             defaultValue, NULL, index ) );
+}
+
+SMP_INLINE const SmpUnit* SmpCommandLine::unitsOf( HelpValueType type )
+{
+    switch( type ) 
+    {
+      case kHelpDuration: return( SmpUnits::kDuration );
+      case kHelpBytes:    return( SmpUnits::kBytes );
+      case kHelpCount:    return( SmpUnits::kCount );
+      default:            return( NULL );
+    }
+}
+
+SMP_INLINE uint64_t SmpCommandLine::convertWithUnit( std::string_view valueString, const SmpUnit* units, uint64_t maxValue, 
+                                                     uint64_t defaultValue, const char* flag, int index )
+{
+    if( valueString.empty() ) 
+        return( defaultValue );
+
+    uint64_t value = defaultValue;
+    SmpConvertResult result = SmpUnits::parse( valueString, units, value );
+
+    if( result.error == kSmpConvertOk && value > maxValue )
+        result = SmpConvertResult{ kSmpConvertOutOfRange, 0 };
+    if( result.error == kSmpConvertOk )
+        return( value );
+
+    char unitList[128];
+    SmpUnits::list( units, unitList, sizeof(unitList) );
+    if( flag != NULL ) {
+        _ERROR_MESSAGE( "Invalid value following flag %s in command line: %s at position %d of '%.*s' (units: %s).\n", 
+                        flag, SmpConvert::errorString( result.error ), (int)result.position, 
+                        (int)valueString.size(), valueString.data(), unitList );
+    } else {
+        _ERROR_MESSAGE( "Invalid value at position %d in command line: %s at position %d of '%.*s' (units: %s).\n", index,
+                        SmpConvert::errorString( result.error ), (int)result.position, 
+                        (int)valueString.size(), valueString.data(), unitList );
+    }
+    if( bQuitOnError ) {
+        exit(-1);
+    } else { 
+        _DEBUG_MESSAGE( "Use default value.\n" );
+        return( defaultValue );
+    }    
+}
+
+SMP_INLINE std::vector<int> SmpCommandLine::getIntegerList( const char* shortFlag, const char* longFlag, char separator, const char* helpMsg )
+{
+    return( extractList<int>( shortFlag, longFlag, separator, helpMsg ) );
+}
+
+SMP_INLINE size_t SmpCommandLine::getIntegerList( const char* shortFlag, const char* longFlag, int* values, size_t capacity, 
+                                                  char separator, const char* helpMsg )
+{
+    return( extractList( shortFlag, longFlag, values, capacity, separator, helpMsg ) );
+}
+
+SMP_INLINE std::vector<double> SmpCommandLine::getDoubleList( const char* shortFlag, const char* longFlag, char separator, const char* helpMsg )
+{
+    return( extractList<double>( shortFlag, longFlag, separator, helpMsg ) );
+}
+
+SMP_INLINE size_t SmpCommandLine::getDoubleList( const char* shortFlag, const char* longFlag, double* values, size_t capacity, 
+                                                 char separator, const char* helpMsg )
+{
+    return( extractList( shortFlag, longFlag, values, capacity, separator, helpMsg ) );
+}
+
+SMP_INLINE std::vector<std::string_view> SmpCommandLine::getStringList( const char* shortFlag, const char* longFlag, char separator, const char* helpMsg )
+{
+    return( extractList<std::string_view>( shortFlag, longFlag, separator, helpMsg ) );
+}
+
+SMP_INLINE size_t SmpCommandLine::getStringList( const char* shortFlag, const char* longFlag, std::string_view* values, size_t capacity, 
+                                                 char separator, const char* helpMsg )
+{
+    return( extractList( shortFlag, longFlag, values, capacity, separator, helpMsg ) );
+}
+
+SMP_INLINE bool SmpCommandLine::getBoolean( const char* shortFlag, const char* longFlag, const char* helpMsg )
+{
+    addHelpMessage( shortFlag, longFlag, kHelpBoolean, helpMsg ).bFlagOnly = true;
+
+    std::string_view valueString = getFlaggedArgument( shortFlag, longFlag, true ); // bIsBoolean == true
+
+    if( !valueString.empty() ) {
+        return( true );
+    } else {  
+        return( false );
+    }
+}
+
+SMP_INLINE bool SmpCommandLine::getBoolean( int index, bool defaultValue, const char* helpMsg )
+{   
+    addHelpMessage( index, kHelpBoolean, helpMsg ).intDefault = defaultValue;
+
+    std::string_view argString = getUnflaggedArgument( index );
+   
+    if( !argString.empty() ) 
+    {
+        int errorCode;
+        bool retValue = string2Bool( argString, defaultValue, &errorCode );
+
+        if( errorCode == 0 ) {
+            return( retValue );
+        } else {
+            _ERROR_MESSAGE( "Invalid argument for boolean type in command line (index=%d), return default value.\n", index );
+            return( defaultValue );
+        } 
+    }
+    else 
+    {
+        return( defaultValue );
+    }
+}
+
+SMP_INLINE std::string SmpCommandLine::getString( const char* shortFlag, const char* longFlag, std::string defaultValue, const char* helpMsg )
+{
+    setHelpText( addHelpMessage( shortFlag, longFlag, kHelpString, helpMsg ), defaultValue );
+    
+    std::string_view valueString = getFlaggedArgument( shortFlag, longFlag );
+
+    if( !valueString.empty() && valueString != kFlagOnlyValue ) 
+        return( std::string( valueString ) );
+    else 
+        return( defaultValue );
+}
+
+SMP_INLINE std::string SmpCommandLine::getString( int index, std::string defaultValue, const char* helpMsg )
+{   
+    setHelpText( addHelpMessage( index, kHelpString, helpMsg ), defaultValue );
+    
+    std::string_view argString = getUnflaggedArgument( index );
+   
+    if( !argString.empty() ) 
+        return( std::string( argString ) );
+    else 
+        return( defaultValue );
+}
+
+SMP_INLINE std::string_view SmpCommandLine::getStringView( const char* shortFlag, const char* longFlag, std::string_view defaultValue, const char* helpMsg )
+{
+    setHelpText( addHelpMessage( shortFlag, longFlag, kHelpString, helpMsg ), defaultValue );
+    
+    std::string_view valueString = getFlaggedArgument( shortFlag, longFlag );
+
+    if( !valueString.empty() && valueString != kFlagOnlyValue ) 
+        return( valueString );
+    else 
+        return( defaultValue );
+}
+
+SMP_INLINE std::string_view SmpCommandLine::getStringView( int index, std::string_view defaultValue, const char* helpMsg )
+{   
+    setHelpText( addHelpMessage( index, kHelpString, helpMsg ), defaultValue );
+    
+    std::string_view argString = getUnflaggedArgument( index );
+   
+    if( !argString.empty() ) 
+        return( argString );
+    else 
+        return( defaultValue );
+}
+
+SMP_INLINE SmpCommandLine::PositionalRange SmpCommandLine::positionals()
+{
+    mbUnflaggedApiCalled = true;
+    mbAllPositionalsWanted = true;
+    return( PositionalRange( this ) );
+}
+
+SMP_INLINE void SmpCommandLine::showHelpMessage()
+{
+    // The whole message is composed into one buffer and written at once:
+    std::pmr::string message( mResource );
+    composeHelpMessage( message );
+
+    smpWriteOutput( message.data(), message.size() );
+
+    mbHelpMsgHasShown = true;
+}
+
+SMP_INLINE bool SmpCommandLine::helpMessageWanted( int minArgc )
+{
+    // Handling help message trigers:
+    bool bHelpMsgWanted = getBoolean( "h", "help", "Show this help message" );
+
+    return( bHelpMsgWanted || (minArgc > 0 && mArgCount < minArgc) );
+}
+
+SMP_INLINE void SmpCommandLine::showHelpMsgOnRequest()
+{
+    // Handling help message trigers:
+    bool bHelpMsgRequested = getBoolean( "h", "help", "Show this help message" );
+
+    if( bHelpMsgRequested && ! mbHelpMsgHasShown )
+        showHelpMessage();
+}
+
+SMP_INLINE int SmpCommandLine::checkValidity( bool bReport )
+{
+    // Drop the results of an earlier check, keep the problems found while parsing and by the 
+    // try-getters:
+    mDiagnostics.erase( std::remove_if( mDiagnostics.begin(), mDiagnostics.end(), []( const SmpDiagnostic& d ) { 
+                                            return( d.kind == kSmpUnknownFlag || d.kind == kSmpMissingValue || 
+                                                    d.kind == kSmpUnexpectedArgument ); } ), 
+                        mDiagnostics.end() );
+
+    for( size_t k = 0; k < helpItems.size(); k++ )
+    {
+        const HelpItem& item = helpItems[k];
+        if( item.source == kFromCommandLine && !item.bFlagOnly && item.value == kFlagOnlyValue )
+        {
+            SmpDiagnostic diagnostic = SmpDiagnostic();
+            diagnostic.kind = kSmpMissingValue;
+            diagnostic.position = findConsumedFlag( item.shortFlag, item.longFlag );
+            diagnostic.text = ( diagnostic.position > 0 ? tokens[ diagnostic.position ].text :
+                                std::string_view( item.longFlag != NULL ? item.longFlag : item.shortFlag ) );
+            mDiagnostics.push_back( diagnostic );
+        }
+    }
+
+    // One pass over the leftovers; positionals are counted as getUnflaggedArgument() does.
+    int positional = 0;
+    for( int i = nextUnconsumed( 1 ); i < (int)tokens.size(); i = nextUnconsumed( i+1 ) )
+    {
+        SmpDiagnostic diagnostic = SmpDiagnostic();
+        diagnostic.text = tokens[i].text;
+        diagnostic.position = i;
+
+        if( tokens[i].kind == kFlagToken ) {
+            diagnostic.kind = kSmpUnknownFlag;
+            suggestFlag( tokens[i], diagnostic );
+        } else if( ++positional > maxUnflaggedArgs && !mbAllPositionalsWanted ) {
+            diagnostic.kind = kSmpUnexpectedArgument;
+        } else {
+            continue;
+        }
+        mDiagnostics.push_back( diagnostic );
+    }
+
+    std::stable_sort( mDiagnostics.begin(), mDiagnostics.end(),
+                      []( const SmpDiagnostic& a, const SmpDiagnostic& b ) { return( a.position < b.position ); } );
+
+    if( bReport )
+        showDiagnostics();
+    return( mDiagnostics.empty() ? 0 : -1 );
+}
+
+SMP_INLINE void SmpCommandLine::showDiagnostics() const
+{
+    for( size_t k = 0; k < mDiagnostics.size(); k++ )
+    {
+        const SmpDiagnostic& d = mDiagnostics[k];
+        if( d.kind == kSmpUnknownFlag && !d.suggestion.empty() ) {
+            _ERROR_MESSAGE( "checkValidity(): Unknown flag %.*s at position %d, did you mean %.*s%.*s?\n", (int)d.text.size(), d.text.data(),
+                            d.position, d.suggestionHyphens, kDoubleHyphen.data(), (int)d.suggestion.size(), d.suggestion.data() );
+        } else if( d.kind == kSmpUnknownFlag ) {
+            _ERROR_MESSAGE( "checkValidity(): Unknown flag %.*s at position %d.\n", (int)d.text.size(), d.text.data(), d.position );
+        } else if( d.kind == kSmpMissingValue ) {
+            _ERROR_MESSAGE( "checkValidity(): Flag %.*s at position %d is missing its value.\n", (int)d.text.size(), d.text.data(), d.position );
+        } else if( d.kind == kSmpUnexpectedArgument ) {
+            _ERROR_MESSAGE( "checkValidity(): Unexpected argument '%.*s' at position %d.\n", (int)d.text.size(), d.text.data(), d.position );
+        } else if( d.kind == kSmpUnterminatedQuote ) {
+            _ERROR_MESSAGE( "Unterminated quote or escape in argument %d, ignored: %.*s\n", d.position, (int)d.text.size(), d.text.data() );
+        } else if( d.kind == kSmpUsageError && !d.flag.empty() ) {
+            _ERROR_MESSAGE( "Source usage error (flag %.*s): %.*s.\n", (int)d.flag.size(), d.flag.data(), (int)d.text.size(), d.text.data() );
+        } else if( d.kind == kSmpUsageError ) {
+            _ERROR_MESSAGE( "Source usage error: %.*s.\n", (int)d.text.size(), d.text.data() );
+        } else if( !d.flag.empty() ) {
+            _ERROR_MESSAGE( "Invalid value '%.*s' following flag %.*s at position %d: %s.\n", (int)d.text.size(), d.text.data(), 
+                            (int)d.flag.size(), d.flag.data(), d.position, SmpConvert::errorString( d.convertError ) );
+        } else {
+            _ERROR_MESSAGE( "Invalid value '%.*s' at position %d: %s.\n", (int)d.text.size(), d.text.data(), 
+                            d.position, SmpConvert::errorString( d.convertError ) );
+        }
+    }
+}
+
+SMP_INLINE SmpParsedArgs SmpCommandLine::freeze()
+{
+    typedef SmpParsedArgs::Entry Entry;
+    typedef SmpParsedArgs::Span  Span;
+
+    std::pmr::vector<Entry> entries( mResource );
+    std::pmr::vector<Span>  spans( mResource );
+    std::pmr::string        pool( mResource );
+
+    // Open-addressing hash over the flag names, filled while the entries are collected:
+    uint32_t slotCount = 8;
+    while( slotCount < helpItems.size() * 4 ) {
+        slotCount *= 2;
+    }
+    std::pmr::vector<uint32_t> slots( slotCount, 0, mResource );
+
+    entries.reserve( helpItems.size() * 2 );
+    for( size_t i = 0; i < helpItems.size(); i++ ) 
+    {
+        const HelpItem& item = helpItems[i];
+        if( item.shortFlag == NULL && item.longFlag == NULL )
+            continue;
+
+        Entry entry = Entry();
+        resolveHelpValue( item, entry, pool );
+
+        for( int k = 0; k < 2; k++ ) 
+        {
+            const char* flag = ( k == 0 ? item.shortFlag : item.longFlag );
+            if( flag == NULL )
+                continue;
+
+            FlagKey key = makeFlagKey( flag, k + 1 );
+            uint32_t slot = SmpParsedArgs::hashKey( key.hyphens, key.name ) & ( slotCount - 1 );
+            while( slots[slot] != 0 && !( entries[ slots[slot]-1 ].hyphens == key.hyphens && 
+                   std::string_view( pool ).substr( entries[ slots[slot]-1 ].nameOffset, entries[ slots[slot]-1 ].nameLength ) == key.name ) ) {
+                slot = ( slot + 1 ) & ( slotCount - 1 );
+            }
+            size_t existing = ( slots[slot] != 0 ? slots[slot] - 1 : entries.size() );
+            if( existing < entries.size() && ( entries[existing].present || !entry.present ) )
+                continue; // the same flag extracted twice (e.g. -h): keep the one that found it
+
+            Entry named = entry;
+            named.hyphens = (uint8_t)key.hyphens;
+            named.nameOffset = (uint32_t)pool.size();
+            named.nameLength = (uint32_t)key.name.size();
+            pool += key.name;
+
+            if( existing < entries.size() ) {
+                entries[existing] = named;
+            } else {
+                entries.push_back( named );
+                slots[slot] = (uint32_t)entries.size();
+            }
+        }
+    }
+
+    for( int i = nextPositional( 1 ); i < (int)tokens.size(); i = nextPositional( i+1 ) ) 
+    {
+        Span span;
+        span.offset = (uint32_t)pool.size();
+        span.length = (uint32_t)tokens[i].text.size();
+        spans.push_back( span );
+        pool += tokens[i].text;
+    }
+
+    uint32_t programOffset = (uint32_t)pool.size();
+    pool += programName();
+
+    // Lay out the flat buffer, 8-byte aligned sections:
+    SmpParsedArgs::Header header = SmpParsedArgs::Header();
+    header.magic = SmpParsedArgs::kMagic;
+    header.version = SmpParsedArgs::kVersion;
+    header.entryCount = (uint32_t)entries.size();
+    header.slotCount = slotCount;
+    header.positionalCount = (uint32_t)spans.size();
+    header.entriesOffset = (uint32_t)alignUp( sizeof(header) );
+    header.slotsOffset = (uint32_t)alignUp( header.entriesOffset + entries.size() * sizeof(Entry) );
+    header.positionalsOffset = (uint32_t)alignUp( header.slotsOffset + slotCount * sizeof(uint32_t) );
+    header.poolOffset = (uint32_t)alignUp( header.positionalsOffset + spans.size() * sizeof(Span) );
+    header.size = (uint32_t)( header.poolOffset + pool.size() );
+    header.programOffset = programOffset;
+    header.programLength = (uint32_t)programName().size();
+
+    std::shared_ptr<uint64_t> buffer( new uint64_t[ alignUp( header.size ) / 8 ](), std::default_delete<uint64_t[]>() );
+    char* base = (char*)buffer.get();
+
+    memcpy( base, &header, sizeof(header) );
+    if( !entries.empty() )
+        memcpy( base + header.entriesOffset, entries.data(), entries.size() * sizeof(Entry) );
+    if( !spans.empty() )
+        memcpy( base + header.positionalsOffset, spans.data(), spans.size() * sizeof(Span) );
+    memcpy( base + header.slotsOffset, slots.data(), slotCount * sizeof(uint32_t) );
+    memcpy( base + header.poolOffset, pool.data(), pool.size() );
+
+    return( SmpParsedArgs( std::shared_ptr<const void>( buffer, base ), base, header.size ) );
+}
+
+SMP_INLINE SmpParsedArgs SmpCommandLine::fromSnapshot( int fd )
+{
+    return( SmpParsedArgs::fromSnapshot( fd ) );
+}
+
+SMP_INLINE void SmpCommandLine::setProgramName( std::string_view name )
+{
+    if( !tokens.empty() )
+        tokens[0].text = name;
+}
+
+SMP_INLINE void SmpCommandLine::setEnvironmentPrefix( const char* prefix )
+{
+    mEnvironmentPrefix = ( prefix != NULL ? prefix : "" );
+}
+
+SMP_INLINE bool SmpCommandLine::loadConfigFile( const char* path )
+{
+    std::shared_ptr<SmpMappedFile> file = std::allocate_shared<SmpMappedFile>( std::pmr::polymorphic_allocator<SmpMappedFile>( mResource ) );
+    if( path == NULL || file->open( path, SMP_RESPONSE_FILE_LIMIT ) != SmpMappedFile::kOpenOk ) 
+    {
+        _ERROR_MESSAGE( "Config file %s can not be read.\n", ( path != NULL ? path : "(null)" ) );
+        if( bQuitOnError ) 
+            exit(-1);
+        else
+            return( false );
+    }
+    configFiles.push_back( file );
+
+    std::string_view text( file->data(), file->size() );
+    std::string_view section;
+    int lineNumber = 0;
+
+    while( !text.empty() ) 
+    {
+        size_t end = text.find( '\n' );
+        std::string_view line = trimSpaces( text.substr( 0, end ) );
+        text.remove_prefix( end == std::string_view::npos ? text.size() : end + 1 );
+        lineNumber++;
+
+        if( line.empty() || line[0] == '#' || line[0] == ';' )
+            continue;
+
+        if( line[0] == '[' && line.back() == ']' ) {
+            section = trimSpaces( line.substr( 1, line.size() - 2 ) );
+            continue;
+        }
+
+        size_t equal = line.find( '=' );
+        if( equal == std::string_view::npos ) {
+            _ERROR_MESSAGE( "%s:%d: expected 'key = value', line ignored.\n", path, lineNumber );
+            continue;
+        }
+
+        ConfigEntry entry;
+        entry.section = section;
+        entry.key = trimSpaces( line.substr( 0, equal ) );
+        entry.value = trimSpaces( line.substr( equal + 1 ) );
+        while( !entry.key.empty() && entry.key[0] == kHyphenchar ) {
+            entry.key.remove_prefix( 1 );
+        }
+        if( entry.value.size() >= 2 && ( entry.value[0] == '"' || entry.value[0] == '\'' ) && entry.value.back() == entry.value[0] ) {
+            entry.value = entry.value.substr( 1, entry.value.size() - 2 );
+        }
+        configEntries.push_back( entry );
+    }
+
+    buildConfigIndex();
+    return( true );
+}
+
+SMP_INLINE void SmpCommandLine::reset( int argc, char *const argv[] )
+{
+    tokens.clear();
+    helpItems.clear();
+    helpTextPool.clear();
+    responseFiles.clear();
+    parse( argc, argv );
+}
+
+SMP_INLINE void SmpCommandLine::reset( std::string_view commandLine )
+{
+    tokens.clear();
+    helpItems.clear();
+    helpTextPool.clear();
+    responseFiles.clear();
+    parse( commandLine );
+}
+
+SMP_INLINE void SmpCommandLine::showVersionInfo()
+{
+    smpPrintMessage( NULL, "%s\n", _VERSION_NUMBER_ );
+}
+
+SMP_INLINE void SmpCommandLine::parse( int argc, char *const argv[] )
+{
+    mArgCount = 0;
+    mResponseFileBytes = 0;
+    mDiagnostics.clear();
+
+    tokens.reserve( argc );
+    for( int i = 0; i < argc; i++ )
+    {
+        appendArgument( std::string_view( argv[i] ), 0 );
+    }
+    finishParse();
+}
+
+SMP_INLINE void SmpCommandLine::parse( std::string_view commandLine )
+{
+    mArgCount = 0;
+    mResponseFileBytes = 0;
+    mDiagnostics.clear();
+
+    const char* text = commandLine.data();
+    size_t size = commandLine.size();
+    size_t pos = 0;
+    char*  out = NULL;
+    std::string_view arg;
+
+    for( int status; ( status = SmpSplit::nextShellArgument( text, size, pos, out, arg ) ) != SmpSplit::kShellEnd; )
+    {
+        if( status == SmpSplit::kShellNeedsBuffer ) 
+        {
+            // The first argument to unquote: it and all later ones fit into the rest of the text.
+            if( mCommandText == NULL || mCommandText.use_count() > 1 ) {
+                mCommandText = std::allocate_shared<std::pmr::string>( std::pmr::polymorphic_allocator<std::pmr::string>( mResource ) );
+            }
+            mCommandText->assign( size - pos, '\0' );
+            out = &(*mCommandText)[0];
+            continue;
+        }
+        if( status == SmpSplit::kShellUnterminated ) {
+            reportUnterminated( arg );
+            break;
+        }
+
+        appendArgument( arg, 0 );
+        if( out != NULL && arg.data() == out )
+            out += arg.size();
+    }
+    finishParse();
+}
+
+SMP_INLINE void SmpCommandLine::reportUnterminated( std::string_view arg )
+{
+    _ERROR_MESSAGE( "Unterminated quote or escape in command line argument %d, ignored: %.*s\n", (int)tokens.size(), 
+                    (int)arg.size(), arg.data() );
+    addDiagnostic( kSmpUnterminatedQuote, arg, kNoValue, (int)tokens.size(), kSmpConvertOk );
+}
+
+SMP_INLINE void SmpCommandLine::finishParse()
+{
+    buildFlagIndex();
+
+    mbWarningHasShown = false;
+    mbHelpMsgHasShown = false;
+    mbUnflaggedApiCalled = false;
+    mbAllPositionalsWanted = false;
+    mbQuiet = false;
+    mLastFlagToken = -1;
+    maxUnflaggedArgs = 0;
+    mCursorIndex = -1;
+    mCursorToken = 0;
+
+    // Bonus extension: show version info of SmpCommandLine(this module, not client software)
+    int versionToken = findFlagToken( makeFlagKey( "SmpCommandLineVersion", 2 ) );
+    if( versionToken >= 0 ) {
+        showVersionInfo();
+        consumeToken( versionToken );
+    }
+}
+
+SMP_INLINE std::string SmpCommandLine::bool2String( bool torf )
+{
+    if( torf )
+        return( std::string("true") );
+    else
+        return( std::string("false") );
+}
+
+SMP_INLINE bool SmpCommandLine::string2Bool( std::string_view boolName, bool defaultValue, int *pErrorCode )
+{
+    static const char* const kFalseNames[] = { "no", "n", "false", "f", "off", "0" };
+    static const char* const kTrueNames[]  = { "yes", "y", "true", "t", "on", "1" };
+
+    for( size_t i = 0; i < sizeof(kFalseNames)/sizeof(kFalseNames[0]); i++ )
+    {
+        if( equalsIgnoreCase( boolName, kFalseNames[i] ) ) {
+            if( pErrorCode != NULL )
+               *pErrorCode = 0;
+            return( false );
+        }
+        if( equalsIgnoreCase( boolName, kTrueNames[i] ) ) {
+            if( pErrorCode != NULL )
+               *pErrorCode = 0;
+            return( true );
+        }
+    }
+
+    if( pErrorCode != NULL )
+       *pErrorCode = -1;
+    return( defaultValue );
+}
+
+SMP_INLINE bool SmpCommandLine::equalsIgnoreCase( std::string_view a, std::string_view b )
+{
+    if( a.size() != b.size() )
+        return( false );
+    for( size_t i = 0; i < a.size(); i++ ) {
+        if( tolower( (unsigned char)a[i] ) != tolower( (unsigned char)b[i] ) )
+            return( false );
+    }
+    return( true );
+}
+
+SMP_INLINE std::string_view SmpCommandLine::getFlaggedArgument( const char* shortFlag, const char* longFlag, bool bIsBoolean )
+{
+    if( shortFlag == NULL && longFlag == NULL ) 
+    {
+        if( mbQuiet ) {
+            addDiagnostic( kSmpUsageError, "shortFlag and longFlag can not both be NULL", kNoValue, -1, kSmpConvertOk );
+            return( kNoValue );
+        }
+        _ERROR_MESSAGE( "Source usage error: shortFlag and longFlag can not both be NULL!");
+        
+        if( bQuitOnError ) 
+            exit(-1);
+        else
+            return( kNoValue );
+    }
+
+    FlagKey shortKey;
+    FlagKey longKey;
+
+    if( shortFlag != NULL )
+    {
+        shortKey = makeFlagKey( shortFlag, 1 );
+    }
+
+    if( longFlag != NULL )
+    {
+        longKey = makeFlagKey( longFlag, 2 );
+
+        if( longFlag[0] == kHyphenchar && longFlag[1] != kHyphenchar ) {
+            // ERROR: User has specified a wrong format of longFlag:
+            if( mbQuiet ) {
+                addDiagnostic( kSmpUsageError, "illegal format of long flag (use '--flag' or 'flag')", longFlag, -1, kSmpConvertOk );
+                return( kNoValue );
+            }
+            _ERROR_MESSAGE( "In %s(), illegal format of long flag in calling. \
+                    (use double hyphen '--flag' or no hyphen 'flag' for long flags", __FUNCTION__ );
+            if( bQuitOnError ) {
+                exit(-1);
+            } else {
+                return( kNoValue );
+            }
+        }
+    }
+
+    if( mbUnflaggedApiCalled && bIsBoolean && !shortKey.is( 1, "h" ) && !longKey.is( 2, "help" ) ) 
+    {   // Can we make this a compile error?!
+        if( mbQuiet ) {
+            addDiagnostic( kSmpUsageError, "flagged boolean extracted after the unflagged arguments", 
+                           ( longFlag != NULL ? longFlag : shortFlag ), -1, kSmpConvertOk );
+        } else {
+            _ERROR_MESSAGE( "WARNING!: Please extract all flagged boolean arguments before extracting unflagged argument!\n" );
+        }
+    }
+
+    // Look up both flag spellings in the index; the earlier occurrence wins:
+    int i = findFlagToken( shortKey );
+    int j = findFlagToken( longKey );
 
-    std::string bool2String( bool torf )
-    {
-        if( torf )
-            return( std::string("true") );
-        else
-            return( std::string("false") );
-    };
+    if( i < 0 || ( j >= 0 && j < i ) )
+        i = j;
+
+    mLastFlagToken = i;
+    if( i < 0 ) {
+        //_DEBUG_MESSAGE( "%s: flag:%s, returns empty string.\n", __FUNCTION__, (shortFlag!=NULL? shortFlag : longFlag) );
+        return( getLayeredArgument( shortFlag, longFlag, bIsBoolean ) );
+    }
 
-    bool string2Bool( std::string boolName, bool defaultValue = false, int *pErrorCode = NULL )
+    // Flag found.
+    consumeToken( i );
+    int v = nextUnconsumed( i );
+    std::string_view value = kFlagOnlyValue;
+
+    // Is this the last argument?
+    if( v < (int)tokens.size() && !tokens[v].text.empty() && !bIsBoolean ) 
     {
-        if( !boolName.empty() ) 
-        {
-            std::string argInLower = boolName;
+        tokens[v].kind = kValueToken;
+        consumeToken( v );
+        value = tokens[v].text;
+    }
 
-            std::transform( argInLower.begin(), argInLower.end(), argInLower.begin(), ::tolower );
+    recordValueSource( shortFlag, longFlag, kFromCommandLine, value );
+    return( value );
+}
 
-            if( argInLower == std::string("no")   || argInLower == std::string("n") || 
-                argInLower == std::string("false")|| argInLower == std::string("f") || 
-                argInLower == std::string("off")  || argInLower == std::string("0") ) 
-            {
-                if( pErrorCode != NULL )
-                    pErrorCode = 0;
-                return( false );
-            } 
-            else if( argInLower == std::string("yes")  || argInLower == std::string("y") || 
-                     argInLower == std::string("true") || argInLower == std::string("t") || 
-                     argInLower == std::string("on")   || argInLower == std::string("1") ) 
-            {
-                if( pErrorCode != NULL )
-                   *pErrorCode = 0;
-                return( true );
-            } 
-            else 
-            {    
-                if( pErrorCode != NULL )
-                   *pErrorCode = -1;
-                return( defaultValue );
-            }
-        } 
-        else 
-        { 
-            if( pErrorCode != NULL )
-               *pErrorCode = -1;
-            return( defaultValue );
+SMP_INLINE std::string_view SmpCommandLine::getLayeredArgument( const char* shortFlag, const char* longFlag, bool bIsBoolean )
+{
+    if( mEnvironmentPrefix.empty() && configEntries.empty() )
+        return( kNoValue );
+
+    std::string_view names[2];
+    names[0] = ( longFlag != NULL ? makeFlagKey( longFlag, 2 ).name : kNoValue );
+    names[1] = ( shortFlag != NULL ? makeFlagKey( shortFlag, 1 ).name : kNoValue );
+
+    ValueSource source = kFromDefault;
+    std::string_view value;
+
+    for( int k = 0; k < 2 && source == kFromDefault; k++ ) 
+    {
+        const char* env = getEnvironmentValue( names[k] );
+        if( env != NULL ) {
+            source = kFromEnvironment;
+            value = env;
         }
-    };
+    }
+    for( int k = 0; k < 2 && source == kFromDefault; k++ ) 
+    {
+        int e = findConfigEntry( names[k] );
+        if( e >= 0 ) {
+            source = kFromConfigFile;
+            value = configEntries[e].value;
+        }
+    }
+
+    if( source == kFromDefault || value.empty() )
+        return( kNoValue );
 
-    std::string getFlaggedArgument( const char* shortFlag, const char* longFlag, bool bIsBoolean=false )
+    if( bIsBoolean ) 
     {
-        if( shortFlag == NULL && longFlag == NULL ) 
-        {
-            _ERROR_MESSAGE( "Source usage error: shortFlag and longFlag can not both be NULL!");
-            
-            if( bQuitOnError ) 
-                exit(-1);
-            else
-                return( kEmptyString );
+        int errorCode;
+        bool bValue = string2Bool( value, false, &errorCode );
+        if( errorCode != 0 && mbQuiet ) {
+            addDiagnostic( kSmpInvalidValue, value, ( longFlag != NULL ? longFlag : shortFlag ), -1, kSmpConvertInvalid );
+            return( kNoValue );
+        }
+        if( errorCode != 0 ) {
+            _ERROR_MESSAGE( "Invalid boolean value '%.*s' for flag %s in the %s, ignored.\n", (int)value.size(), value.data(),
+                            ( longFlag != NULL ? longFlag : shortFlag ), ( source == kFromEnvironment ? "environment" : "config file" ) );
+            return( kNoValue );
         }
+        value = ( bValue ? kFlagOnlyValue : kNoValue );
+    }
+
+    recordValueSource( shortFlag, longFlag, source, value );
+    return( value );
+}
+
+SMP_INLINE void SmpCommandLine::recordValueSource( const char* shortFlag, const char* longFlag, ValueSource source, std::string_view value )
+{
+    if( !helpItems.empty() && helpItems.back().shortFlag == shortFlag && helpItems.back().longFlag == longFlag ) {
+        helpItems.back().source = source;
+        helpItems.back().value = value;
+    }
+}
+
+SMP_INLINE const char* SmpCommandLine::getEnvironmentValue( std::string_view name ) const
+{
+    char variable[256];
+
+    if( mEnvironmentPrefix.empty() || name.empty() || mEnvironmentPrefix.size() + name.size() + 2 > sizeof(variable) )
+        return( NULL );
+
+    size_t n = mEnvironmentPrefix.size();
+    memcpy( variable, mEnvironmentPrefix.data(), n );
+    variable[n++] = '_';
+    for( size_t i = 0; i < name.size(); i++ ) {
+        char c = name[i];
+        variable[n++] = ( c == '-' || c == '.' ) ? '_' : (char)toupper( (unsigned char)c );
+    }
+    variable[n] = '\0';
+
+    return( getenv( variable ) );
+}
+
+SMP_INLINE std::string_view SmpCommandLine::getUnflaggedArgument( int index )
+{   
+    mbUnflaggedApiCalled = true;
+    
+    if( index > maxUnflaggedArgs )
+        maxUnflaggedArgs = index;
 
-        std::string shortFlagStr;
-        std::string longFlagStr;
+    // Resume from the last lookup, so that a loop over getString( 1..N ) stays linear:
+    int i = nextUnconsumed( 0 );
+    int pi = 0;
+    if( mCursorIndex >= 0 && mCursorIndex <= index ) {
+        i = mCursorToken;
+        pi = mCursorIndex;
+    }
 
-        if( shortFlag != NULL )
+    for( ; i < (int)tokens.size(); i = nextUnconsumed( i+1 ) )
+    {
+        if( tokens[i].kind == kFlagToken )
         {
-            if( shortFlag[0] != kHyphenchar ) {
-                shortFlagStr = kSingleHyphen + shortFlag;
-            } else {
-                shortFlagStr = std::string(shortFlag);
+            if( !mbWarningHasShown && !mbQuiet && tokens[i].text != "-h" && tokens[i].text != "--help" ) {
+                _DEBUG_MESSAGE ("WARNING! There may be unknown flags in the command line, or in source code you have extracted\n" ); 
+                _DEBUG_MESSAGE ("         unflagged arguments before extracting all the flagged ones.\n");
+                _DEBUG_MESSAGE ("         Consult the readme description in SmpCommandLine.hpp for details.\n");
+                mbWarningHasShown = true;
+            }
+        } 
+        else 
+        {
+            if( pi == index ) {
+                mCursorIndex = pi;
+                mCursorToken = i;
+                return( tokens[i].text );
+            } else { 
+                pi++;
             }
         }
+    }
+    return( kNoValue );
+}
+
+SMP_INLINE bool SmpCommandLine::isFlagLetter( char c )
+{
+    return( (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') );
+}
+
+SMP_INLINE SmpCommandLine::FlagKey SmpCommandLine::makeFlagKey( std::string_view flag, int defaultHyphens )
+{
+    FlagKey key;
+    if( flag.empty() || flag[0] != '-' ) {
+        key.hyphens = defaultHyphens;
+    } else {
+        key.hyphens = ( flag.size() > 1 && flag[1] == '-' ) ? 2 : 1;
+    }
+    key.name = flag.substr( flag.empty() || flag[0] != '-' ? 0 : key.hyphens );
+    return( key );
+}
+
+SMP_INLINE SmpCommandLine::FlagKey SmpCommandLine::tokenFlagKey( const Token& token )
+{
+    FlagKey key;
+    key.hyphens = token.hyphens;
+    key.name = token.text.substr( token.hyphens );
+    return( key );
+}
 
-        if( longFlag != NULL )
+SMP_INLINE void SmpCommandLine::appendArgument( std::string_view arg, int depth )
+{
+    if( arg.size() > 1 && arg[0] == '@' && !tokens.empty() && mMaxResponseFileBytes > 0 ) 
+    {
+        if( expandResponseFile( arg.substr( 1 ), depth + 1 ) )
+            return;
+    }
+    mArgCount++;
+
+    // Split the combined single flags (e.g.: '-xzvf' expland to -x -z -v -f)
+    if( arg.size() > 2 && arg[0] == kHyphenchar && arg[1] != kHyphenchar && isFlagLetter( arg[1] ) )
+    {
+        for( size_t j = 1; j < arg.size(); j++ )
         {
-            if( longFlag[0] != kHyphenchar ) {
-                longFlagStr = kDoubleHyphen + longFlag;
+            if( isFlagLetter( arg[j] ) ) {
+                appendToken( shortFlagText( arg[j] ) );
             } else {
-                longFlagStr = std::string(longFlag);
+                appendToken( arg.substr( j ) );
+                break;
             }
+        }
+    } else {
+        appendToken( arg );
+    }
+}
 
-            if( longFlag[0] == kHyphenchar && longFlag[1] != kHyphenchar ) {
-                // ERROR: User has specified a wrong format of longFlag:
-                _ERROR_MESSAGE( "In %s(), illegal format of long flag in calling. \
-                        (use double hyphen '--flag' or no hyphen 'flag' for long flags", __FUNCTION__ );
-                if( bQuitOnError ) {
-                    exit(-1);
-                } else {
-                    return( kEmptyString );
-                }
-            }
+SMP_INLINE bool SmpCommandLine::expandResponseFile( std::string_view path, int depth )
+{
+    const int kMaxDepth = 16;
+    char pathBuffer[4096];
+
+    if( depth > kMaxDepth || path.size() >= sizeof(pathBuffer) ) {
+        _ERROR_MESSAGE( "Response file @%.*s skipped (nested too deep or path too long).\n", (int)path.size(), path.data() );
+        return( false );
+    }
+    memcpy( pathBuffer, path.data(), path.size() );
+    pathBuffer[ path.size() ] = '\0';
+
+    std::shared_ptr<SmpMappedFile> file = std::allocate_shared<SmpMappedFile>( std::pmr::polymorphic_allocator<SmpMappedFile>( mResource ) );
+    int status = file->open( pathBuffer, mMaxResponseFileBytes - mResponseFileBytes );
+
+    if( status == SmpMappedFile::kOpenTooLarge ) {
+        _ERROR_MESSAGE( "Response file @%s skipped: exceeds the limit of %llu bytes in total.\n", 
+                        pathBuffer, (unsigned long long)mMaxResponseFileBytes );
+    }
+    if( status != SmpMappedFile::kOpenOk )
+        return( false );
+
+    mResponseFileBytes += file->size();
+    responseFiles.push_back( file );
+
+    char*  text = file->data();
+    size_t size = file->size();
+    size_t pos = 0;
+    std::string_view arg;
+
+    // The mapping is private, so arguments are unquoted in place:
+    int shellStatus;
+    while( ( shellStatus = SmpSplit::nextShellArgument( text, size, pos, text + pos, arg ) ) == SmpSplit::kShellArgument ) {
+        appendArgument( arg, depth );
+    }
+    if( shellStatus == SmpSplit::kShellUnterminated )
+        reportUnterminated( arg );
+    return( true );
+}
+
+SMP_INLINE std::string_view SmpCommandLine::shortFlagText( char letter )
+{
+    int offset = ( letter >= 'a' && letter <= 'z' ) ? ( letter - 'a' ) : ( 26 + letter - 'A' );
+    return( std::string_view( kShortFlagTexts + offset*2, 2 ) );
+}
+
+SMP_INLINE void SmpCommandLine::appendToken( std::string_view text )
+{
+    Token token;
+    token.text = text;
+    token.kind = ( !text.empty() && text[0] == kHyphenchar ? kFlagToken : kPositionalToken );
+    token.hyphens = ( token.kind != kFlagToken ? 0 : ( text.size() > 1 && text[1] == kHyphenchar ? 2 : 1 ) );
+    token.consumed = false;
+    token.nextLive = (int)tokens.size();
+    token.nextSameFlag = -1;
+    tokens.push_back( token );
+}
+
+SMP_INLINE std::string_view SmpCommandLine::programName() const
+{
+    return( tokens.empty() ? kNoValue : tokens[0].text );
+}
+
+SMP_INLINE size_t SmpCommandLine::hashFlag( const FlagKey& key )
+{
+    return( hashName( key.name, 2166136261u ^ (size_t)key.hyphens ) );
+}
+
+SMP_INLINE size_t SmpCommandLine::hashName( std::string_view name, size_t h )
+{
+    for( size_t i = 0; i < name.size(); i++ ) {
+        h = ( h ^ (unsigned char)name[i] ) * 16777619u;
+    }
+    return( h );
+}
+
+SMP_INLINE std::string_view SmpCommandLine::trimSpaces( std::string_view text )
+{
+    while( !text.empty() && isspace( (unsigned char)text[0] ) ) {
+        text.remove_prefix( 1 );
+    }
+    while( !text.empty() && isspace( (unsigned char)text.back() ) ) {
+        text.remove_suffix( 1 );
+    }
+    return( text );
+}
+
+SMP_INLINE size_t SmpCommandLine::hashConfigEntry( const ConfigEntry& entry )
+{
+    if( entry.section.empty() )
+        return( hashName( entry.key ) );
+    return( hashName( entry.key, hashName( ".", hashName( entry.section ) ) ) );
+}
+
+SMP_INLINE bool SmpCommandLine::configEntryIs( const ConfigEntry& entry, std::string_view name )
+{
+    if( entry.section.empty() )
+        return( entry.key == name );
+    return( name.size() == entry.section.size() + 1 + entry.key.size() && name[ entry.section.size() ] == '.' &&
+            name.substr( 0, entry.section.size() ) == entry.section && name.substr( entry.section.size() + 1 ) == entry.key );
+}
+
+SMP_INLINE void SmpCommandLine::buildConfigIndex()
+{
+    size_t tableSize = 8;
+    while( tableSize < configEntries.size() * 2 ) {
+        tableSize *= 2;
+    }
+    configIndex.assign( tableSize, -1 );
+
+    for( size_t e = 0; e < configEntries.size(); e++ ) 
+    {
+        size_t slot = hashConfigEntry( configEntries[e] ) & ( tableSize - 1 );
+        while( configIndex[slot] >= 0 ) 
+        {
+            const ConfigEntry& other = configEntries[ configIndex[slot] ];
+            if( other.section == configEntries[e].section && other.key == configEntries[e].key )
+                break;
+            slot = ( slot + 1 ) & ( tableSize - 1 );
         }
+        configIndex[slot] = (int)e;
+    }
+}
 
-        if( mbUnflaggedApiCalled && bIsBoolean && shortFlagStr != std::string("-h") && longFlagStr != std::string("--help") ) 
-        {   // Can we make this a compile error?!
-            _ERROR_MESSAGE( "WARNING!: Please extract all flagged boolean arguments before extracting unflagged argument!\n" );
+SMP_INLINE int SmpCommandLine::findConfigEntry( std::string_view name ) const
+{
+    if( name.empty() || configIndex.empty() )
+        return( -1 );
+
+    size_t mask = configIndex.size() - 1;
+    for( size_t slot = hashName( name ) & mask; configIndex[slot] >= 0; slot = ( slot + 1 ) & mask ) 
+    {
+        if( configEntryIs( configEntries[ configIndex[slot] ], name ) )
+            return( configIndex[slot] );
+    }
+    return( -1 );
+}
+
+SMP_INLINE size_t SmpCommandLine::findFlagSlot( const FlagKey& key ) const
+{
+    size_t mask = flagIndex.size() - 1;
+    size_t slot = hashFlag( key ) & mask;
+
+    while( flagIndex[slot] >= 0 && !tokenFlagKey( tokens[flagIndex[slot]] ).is( key.hyphens, key.name ) ) {
+        slot = ( slot + 1 ) & mask;
+    }
+    return( slot );
+}
+
+SMP_INLINE void SmpCommandLine::buildFlagIndex()
+{
+    size_t flagCount = 0;
+    for( size_t i = 0; i < tokens.size(); i++ ) {
+        if( tokens[i].kind == kFlagToken ) 
+            flagCount++;
+    }
+
+    size_t tableSize = 8;
+    while( tableSize < flagCount * 2 ) {
+        tableSize *= 2;
+    }
+    flagIndex.assign( tableSize, -1 );
+
+    // Insert backwards so that every chain is ordered by position:
+    for( int i = (int)tokens.size()-1; i >= 1; i-- ) 
+    {
+        if( tokens[i].kind == kFlagToken ) {
+            size_t slot = findFlagSlot( tokenFlagKey( tokens[i] ) );
+            tokens[i].nextSameFlag = flagIndex[slot];
+            flagIndex[slot] = i;
         }
+    }
+}
+
+SMP_INLINE int SmpCommandLine::findFlagToken( const FlagKey& key )
+{
+    if( key.hyphens == 0 || flagIndex.empty() )
+        return( -1 );
+
+    size_t slot = findFlagSlot( key );
+    int i = flagIndex[slot];
+
+    // Drop consumed heads so that repeated lookups stay O(1). The chain tail is kept even when
+    // consumed, since an emptied slot would break the probe sequence of other flags.
+    while( i >= 0 && tokens[i].consumed && tokens[i].nextSameFlag >= 0 ) {
+        i = tokens[i].nextSameFlag;
+    }
+    if( i >= 0 )
+        flagIndex[slot] = i;
+
+    return( ( i >= 0 && !tokens[i].consumed ) ? i : -1 );
+}
+
+SMP_INLINE int SmpCommandLine::nextPositional( int i )
+{
+    i = nextUnconsumed( i );
+    while( i < (int)tokens.size() && tokens[i].kind == kFlagToken ) {
+        i = nextUnconsumed( i+1 );
+    }
+    return( i );
+}
+
+SMP_INLINE void SmpCommandLine::consumeToken( int i )
+{
+    mCursorIndex = -1;
+    tokens[i].consumed = true;
+    tokens[i].nextLive = i + 1;
+}
+
+SMP_INLINE int SmpCommandLine::nextUnconsumed( int i )
+{
+    int n = (int)tokens.size();
+    int root = i;
+
+    while( root < n && tokens[root].nextLive != root ) {
+        root = tokens[root].nextLive;
+    }
+    while( i < n && tokens[i].nextLive != i ) {
+        int next = tokens[i].nextLive;
+        tokens[i].nextLive = root;
+        i = next;
+    }
+    return( root );
+}
 
-        // Search in the argument list to find the specified flag:
-        for( int i = 0; i < arguments.size(); i++ )
+SMP_INLINE int SmpCommandLine::findConsumedFlag( const char* shortFlag, const char* longFlag ) const
+{
+    for( int i = 1; i < (int)tokens.size(); i++ )
+    {
+        if( tokens[i].kind != kFlagToken || !tokens[i].consumed )
+            continue;
+        for( int h = 1; h <= 2; h++ ) 
         {
-            //std::cout << "i="<<i<<" "<<arguments[i] << " vs " << kSingleHyphen + shortFlag << std::endl;
-            if( ( shortFlag != NULL && arguments[i] == shortFlagStr ) || 
-                 ( longFlag != NULL && arguments[i] == longFlagStr ) )
-            {
-                // Flag found.
-                arguments.erase( arguments.begin()+i );
-                
-                // Is this the last argument?
-                if( i < arguments.size() && !arguments[i].empty() ) 
-                {
-                    if( bIsBoolean ) //&& arguments[i][0] == kHyphenchar ) 
-                    {
-                        return( kSpaceString );
-                    } else {
-                        std::string valueString = arguments[i];
-                        arguments.erase( arguments.begin()+i );
-                        return( valueString );
-                    }
-                } else {
-                    return( kSpaceString );
-                }
-                i--; // important!!
-            }
+            const char* flag = ( h == 1 ? shortFlag : longFlag );
+            FlagKey key = ( flag != NULL ? makeFlagKey( flag, h ) : FlagKey() );
+            if( flag != NULL && tokenFlagKey( tokens[i] ).is( key.hyphens, key.name ) )
+                return( i );
         }
-        //_DEBUG_MESSAGE( "%s: flag:%s, returns empty string.\n", __FUNCTION__, (shortFlag!=NULL? shortFlag : longFlag) );
-        return( kEmptyString );
-    };
+    }
+    return( -1 );
+}
 
-    std::string getUnflaggedArgument( int index )
-    {   
-        mbUnflaggedApiCalled = true;
-        
-        if( index > maxUnflaggedArgs )
-            maxUnflaggedArgs = index;
+SMP_INLINE void SmpCommandLine::suggestFlag( const Token& token, SmpDiagnostic& diagnostic ) const
+{
+    FlagKey unknown = tokenFlagKey( token );
+    SmpEditDistance pattern( unknown.name );
+    int limit = ( (int)unknown.name.size() + 1 ) / 3;
+    int bestScore = 2 * limit + 2;
 
-        for( int i = 0, pi = 0; i < arguments.size(); i++ )
+    for( size_t k = 0; k < helpItems.size() && pattern.valid(); k++ )
+    {
+        for( int h = 1; h <= 2; h++ ) 
         {
-            if( arguments[i][0] == '-' )
-            {
-                if( !mbWarningHasShown && arguments[i] != std::string("-h") && arguments[i] != std::string("--help") ) {
-                    _DEBUG_MESSAGE ("WARNING! There may be unknown flags in the command line, or in source code you have extracted\n" ); 
-                    _DEBUG_MESSAGE ("         unflagged arguments before extracting all the flagged ones.\n");
-                    _DEBUG_MESSAGE ("         Consult the readme description in SmpCommandLine.hpp for details.\n");
-                    mbWarningHasShown = true;
-                }
-            } 
-            else 
-            {
-                if( pi == index ) {
-                    return( arguments[i] );
-                } else { 
-                    pi++;
-                }
+            const char* flag = ( h == 1 ? helpItems[k].shortFlag : helpItems[k].longFlag );
+            if( flag == NULL )
+                continue;
+
+            FlagKey key = makeFlagKey( flag, h );
+            int score = 2 * pattern.distance( key.name, limit ) + ( key.hyphens != unknown.hyphens );
+            if( score > 0 && score < bestScore ) {  // 0: a repeated flag, not a typo
+                bestScore = score;
+                diagnostic.suggestionHyphens = key.hyphens;
+                diagnostic.suggestion = key.name;
             }
         }
-        return( kEmptyString );
-    };
+    }
+}
+
+SMP_INLINE const SmpDiagnostic& SmpCommandLine::addDiagnostic( SmpDiagnosticKind kind, std::string_view text, std::string_view flag, int position, 
+                                                               SmpConvertError error )
+{
+    SmpDiagnostic diagnostic = SmpDiagnostic();
+    diagnostic.kind = kind;
+    diagnostic.text = text;
+    diagnostic.flag = flag;
+    diagnostic.position = position;
+    diagnostic.convertError = error;
+    mDiagnostics.push_back( diagnostic );
+    return( mDiagnostics.back() );
+}
+
+SMP_INLINE SmpCommandLine::HelpItem& SmpCommandLine::addHelpMessage( const char* shortFlag, const char* longFlag, HelpValueType type, const char* helpMsg )
+{
+    HelpItem item = HelpItem();
+    item.shortFlag = shortFlag;
+    item.longFlag = longFlag;
+    item.type = type;
+    item.helpMsg = ( helpMsg != NULL ? helpMsg : "" );
+
+    helpItems.push_back( item );
+    return( helpItems.back() );
+}
+
+SMP_INLINE void SmpCommandLine::resolveHelpValue( const HelpItem& item, SmpParsedArgs::Entry& entry, std::pmr::string& pool )
+{
+    bool bPresent = ( item.source != kFromDefault );
+    bool bHasValue = bPresent && !item.value.empty() && item.value != kFlagOnlyValue;
+    std::string_view text = ( bHasValue ? item.value : kNoValue );
+
+    entry.present = bPresent;
+    entry.intValue = item.intDefault;
+    entry.realValue = item.realDefault;
 
-    void addHelpMessage( const char* shortFlag, const char* longFlag, const std::string defaultStr, 
-                         const char* helpMsg, bool bIsBoolean = false )
+    switch( item.type ) 
     {
-        // Constuct help message for this item:
-        std::string helpStr;
+      case kHelpInteger:
+        entry.type = SmpParsedArgs::kInteger;
+        if( !bHasValue || SmpConvert::toInteger( text, entry.intValue ).error != kSmpConvertOk )
+            entry.intValue = item.intDefault;
+        entry.realValue = (double)entry.intValue;
+        break;
+      case kHelpUnsigned: {
+        entry.type = SmpParsedArgs::kUnsigned;
+        uint64_t value = (uint64_t)item.intDefault;
+        if( bHasValue && SmpConvert::toInteger( text, value ).error != kSmpConvertOk )
+            value = (uint64_t)item.intDefault;
+        entry.intValue = (int64_t)value;
+        entry.realValue = (double)value;
+        break;
+      }
+      case kHelpReal:
+        entry.type = SmpParsedArgs::kReal;
+        if( !bHasValue || SmpConvert::toReal( text, entry.realValue ).error != kSmpConvertOk )
+            entry.realValue = item.realDefault;
+        entry.intValue = (int64_t)entry.realValue;
+        break;
+      case kHelpDuration:
+      case kHelpBytes:
+      case kHelpCount: {
+        // In nanoseconds, bytes or units, as the getter returned it:
+        entry.type = ( item.type == kHelpDuration ? SmpParsedArgs::kInteger : SmpParsedArgs::kUnsigned );
+        uint64_t value = (uint64_t)item.intDefault;
+        if( bHasValue && SmpUnits::parse( text, unitsOf( item.type ), value ).error != kSmpConvertOk )
+            value = (uint64_t)item.intDefault;
+        if( item.type == kHelpDuration && value > (uint64_t)std::numeric_limits<int64_t>::max() )
+            value = (uint64_t)item.intDefault;
+        entry.intValue = (int64_t)value;
+        entry.realValue = (double)value;
+        break;
+      }
+      case kHelpBoolean:
+        entry.type = SmpParsedArgs::kBoolean;
+        entry.intValue = ( bPresent ? !item.value.empty() : item.intDefault != 0 );
+        entry.realValue = (double)entry.intValue;
+        break;
+      case kHelpString:
+        entry.type = SmpParsedArgs::kString;
+        if( !bHasValue )
+            text = helpText( item );
+        break;
+      default:
+        entry.type = SmpParsedArgs::kList;
+        break;
+    }
 
-        if( shortFlag != NULL ) {
-            std::string shortFlagStr(shortFlag); 
+    entry.textOffset = (uint32_t)pool.size();
+    entry.textLength = (uint32_t)text.size();
+    pool += text;
+}
 
-            if( shortFlagStr[0] != kHyphenchar ) {
-                shortFlagStr = kSingleHyphen + shortFlag;
-            }
-            helpStr = helpStr + shortFlagStr;
+SMP_INLINE void SmpCommandLine::setHelpText( HelpItem& item, std::string_view text )
+{
+    item.textOffset = helpTextPool.size();
+    item.textLength = text.size();
+    helpTextPool += text;
+}
+
+SMP_INLINE std::string_view SmpCommandLine::helpText( const HelpItem& item ) const
+{
+    return( std::string_view( helpTextPool ).substr( item.textOffset, item.textLength ) );
+}
+
+SMP_INLINE void SmpCommandLine::appendNumber( std::pmr::string& out, long long number )
+{
+    char digits[24];
+    std::to_chars_result r = std::to_chars( digits, digits + sizeof(digits), number );
+    out.append( digits, r.ptr - digits );
+}
+
+SMP_INLINE SmpCommandLine::HelpItem& SmpCommandLine::addHelpMessage( int index, HelpValueType type, const char* helpMsg )
+{
+    HelpItem& item = addHelpMessage( NULL, NULL, type, helpMsg );
+    item.index = index;
+    return( item );
+}
+
+SMP_INLINE size_t SmpCommandLine::appendHelpColumn( std::pmr::string& out, const HelpItem& item )
+{
+    size_t start = out.size();
+
+    if( item.shortFlag == NULL && item.longFlag == NULL ) {
+        out += "argument";
+        appendNumber( out, item.index );
+        return( out.size() - start );
+    }
+
+    if( item.shortFlag != NULL ) {
+        if( item.shortFlag[0] != kHyphenchar ) 
+            out += '-';
+        out += item.shortFlag;
+    }
+
+    if( item.shortFlag != NULL && item.longFlag != NULL ) {
+        out += '/';
+    }
+
+    if( item.longFlag != NULL ) {
+        if( item.longFlag[0] != kHyphenchar ) 
+            out += "--";
+        out += item.longFlag;
+    }
+
+    if( item.type == kHelpList ) {
+        out += " val";
+        out += item.separator;
+        out += "val...";
+    } else if( !item.bFlagOnly ) {
+        out += " val";
+    }
+
+    return( out.size() - start );
+}
+
+SMP_INLINE bool SmpCommandLine::appendHelpDefault( std::pmr::string& out, const HelpItem& item )
+{
+    char number[32];
+
+    switch( item.type ) 
+    {
+      case kHelpInteger:
+        snprintf( number, sizeof(number), "%lld", item.intDefault );
+        out += number;
+        return( true );
+      case kHelpUnsigned:
+        snprintf( number, sizeof(number), "%llu", (unsigned long long)item.intDefault );
+        out += number;
+        return( true );
+      case kHelpReal:
+        snprintf( number, sizeof(number), "%g", item.realDefault );
+        out += number;
+        return( true );
+      case kHelpBoolean:
+        out += ( item.intDefault != 0 ? "true" : "false" );
+        return( true );
+      case kHelpDuration:
+      case kHelpBytes:
+      case kHelpCount:
+        if( item.type == kHelpDuration && item.intDefault < 0 ) {  // byte sizes and counts are unsigned
+            out += '-';
+            SmpUnits::format( 0 - (uint64_t)item.intDefault, unitsOf( item.type ), number, sizeof(number) );
+        } else {
+            SmpUnits::format( (uint64_t)item.intDefault, unitsOf( item.type ), number, sizeof(number) );
         }
+        out += number;
+        return( true );
+      default:
+        out += helpText( item );
+        return( item.textLength > 0 );
+    }
+}
+
+SMP_INLINE void SmpCommandLine::composeHelpMessage( std::pmr::string& message )
+{
+    std::string_view program = programName();
+    bool bLayered = !mEnvironmentPrefix.empty() || !configEntries.empty();
+    std::pmr::string column( mResource );
+    size_t columnWidth = 0;
+    size_t estimate = program.size()*2 + 64;
 
-        if( shortFlag != NULL && longFlag != NULL ) {
-            helpStr = helpStr + "/";
+    for( size_t i = 0; i < helpItems.size(); i++ ) 
+    {
+        column.clear();
+        size_t width = appendHelpColumn( column, helpItems[i] );
+        columnWidth = std::max( columnWidth, width );
+        estimate += width*2 + strlen( helpItems[i].helpMsg ) + helpItems[i].textLength + helpItems[i].choicesLength + 60;
+    }
+    message.reserve( estimate + columnWidth * helpItems.size() );
+
+    message += "Usage of ";
+    message += program;
+    message += ":\n";
+
+    // The first line: the program name, the unflagged arguments, and then all the flags:
+    message += program;
+    message += ' ';
+    for( int i = 0; i < maxUnflaggedArgs && i < 3; i++ ) {
+        message += "[argument";
+        appendNumber( message, i+1 );
+        message += "] ";
+    }
+    if( maxUnflaggedArgs > 3 ) {
+        message += "... ";
+    }
+    for( size_t i = 0; i < helpItems.size(); i++ ) 
+    {
+        if( helpItems[i].shortFlag != NULL || helpItems[i].longFlag != NULL ) {
+            message += '[';
+            appendHelpColumn( message, helpItems[i] );
+            message += "] ";
         }
+    }
+    message += '\n';
 
-        if( longFlag != NULL ) {
-            std::string longFlagStr(longFlag);
+    // One aligned line per item:
+    for( size_t i = 0; i < helpItems.size(); i++ ) 
+    {
+        message += '\t';
+        size_t width = appendHelpColumn( message, helpItems[i] );
+        message.append( columnWidth - width, ' ' );
+        message += " : ";
+        message += helpItems[i].helpMsg;
+        if( helpItems[i].choicesLength > 0 ) {
+            message += " (one of: ";
+            message += std::string_view( helpTextPool ).substr( helpItems[i].choicesOffset, helpItems[i].choicesLength );
+            message += ')';
+        }
 
-            if( longFlagStr[0] != kHyphenchar ) {
-                longFlagStr = kDoubleHyphen + longFlag;
-            }
-            helpStr = helpStr + longFlagStr;
+        size_t mark = message.size();
+        message += " (default value: ";
+        if( appendHelpDefault( message, helpItems[i] ) ) {
+            message += ')';
+        } else {
+            message.resize( mark );
         }
 
-        if( !bIsBoolean )
-            helpStr = helpStr + " val";
-        
-        // Add info to the first line of help message:
-        firstLineFlagMsg += "["+helpStr+"] ";
-        
-        helpStr = helpStr + " : ";
-        helpStr = helpStr + helpMsg;
-        
-        if( !defaultStr.empty() )
-            helpStr = helpStr + " (defualt value:" + defaultStr + ")";
-        
-        helpMessageQueue.push_back(helpStr);
-    };
+        // With layered sources, show which one supplied the value:
+        if( bLayered && helpItems[i].index == 0 ) {
+            static const char* const kSourceNames[] = { "default", "command line", "environment", "config file" };
+            message += " [from ";
+            message += kSourceNames[ helpItems[i].source ];
+            message += ']';
+        }
+        message += '\n';
+    }
+}
 
-    void addHelpMessage( int index, const std::string defaultStr, const char* helpMsg )
-    {
-        std::string helpStr;
+SMP_INLINE SmpCommandLine::SmpCommandLine() : mResource( defaultResource() ) {
+    mArgCount = 0 ;
+    maxUnflaggedArgs = 0;
+    mbWarningHasShown = false;
+    mbHelpMsgHasShown = false;
+    mbUnflaggedApiCalled = false;
+    mbAllPositionalsWanted = false;
+    mbQuiet = false;
+    mLastFlagToken = -1;
+    mCursorIndex = -1;
+    mCursorToken = 0;
+    mResponseFileBytes = 0;
+    mMaxResponseFileBytes = 0;
+}
 
-        helpStr = helpStr + "argument" + std::to_string(index) + ": ";
-        helpStr = helpStr + helpMsg;
 
-        if( !defaultStr.empty() )
-            helpStr = helpStr + " (defualt value: " + defaultStr + ")";
-        
-        helpMessageQueue.push_back(helpStr);
-    };
+// SmpSubcommands:
 
-    // Forbid calling of default constructor (force user to pass argc and argv into constructor method
-    // (defined below):
-    SmpCommandLine(){
-        int  mArgCount = 0 ;
-        int  maxUnflaggedArgs = 0;
-        bool mbWarningHasShown = false;
-        bool mbHelpMsgHasShown = false;
-        bool mbUnflaggedApiCalled = false;
-    };
-}; 
+SMP_INLINE void SmpSubcommands::add( const char* name, Handler handler, const char* helpMsg )
+{
+    Subcommand command;
+    command.name = name;
+    command.handler = handler;
+    command.helpMsg = ( helpMsg != NULL ? helpMsg : "" );
+
+    if( !mIndex.emplace( std::string_view( name ), mCommands.size() ).second ) {
+        _ERROR_MESSAGE( "Source usage error: subcommand '%s' is added twice!\n", name );
+        return;
+    }
+    mCommands.push_back( command );
+}
+
+SMP_INLINE int SmpSubcommands::dispatch( int argc, char *const argv[] )
+{
+    mProgramName = ( argc > 0 ? argv[0] : "" );
+    mSubcommandIndex = 0;
+
+    for( int i = 1; i < argc; i++ ) {
+        if( argv[i][0] != '-' ) {
+            mSubcommandIndex = i;
+            break;
+        }
+    }
+
+    if( mSubcommandIndex == 0 ) {
+        showHelpMessage();
+        return( -1 );
+    }
+
+    std::unordered_map<std::string_view, size_t>::const_iterator found = mIndex.find( argv[mSubcommandIndex] );
+    if( found == mIndex.end() ) {
+        _ERROR_MESSAGE( "Unknown subcommand '%s'.\n", argv[mSubcommandIndex] );
+        showHelpMessage();
+        return( -1 );
+    }
+
+    // Only the selected subcommand gets a parser, over 'subcommand arguments...':
+    const Subcommand& command = mCommands[found->second];
+    SmpCommandLine parser( argc - mSubcommandIndex, argv + mSubcommandIndex );
+
+    mScopedName = mProgramName;
+    mScopedName += ' ';
+    mScopedName += command.name;
+    parser.setProgramName( mScopedName );
+
+    return( command.handler( parser ) );
+}
+
+SMP_INLINE void SmpSubcommands::showHelpMessage()
+{
+    size_t width = 0;
+    for( size_t i = 0; i < mCommands.size(); i++ ) {
+        width = std::max( width, strlen( mCommands[i].name ) );
+    }
+
+    std::string message;
+    message.reserve( 64 + mCommands.size() * ( width + 64 ) );
+    message += "Usage of ";
+    message += mProgramName;
+    message += ":\n";
+    message += mProgramName;
+    message += " <subcommand> [arguments] ...  (see '<subcommand> --help')\n";
+
+    for( size_t i = 0; i < mCommands.size(); i++ ) 
+    {
+        message += '\t';
+        message += mCommands[i].name;
+        message.append( width - strlen( mCommands[i].name ), ' ' );
+        message += " : ";
+        message += mCommands[i].helpMsg;
+        message += '\n';
+    }
 
+    smpWriteOutput( message.data(), message.size() );
+}
 
+#endif // !SMP_PREBUILT || SMP_IMPLEMENTATION
@@ -0,0 +1,534 @@
+// SmpCommandLine_Benchmark.cpp
+// Parse-throughput benchmark of SmpCommandLine.hpp
+// Compile: $ g++ -O2 -std=c++17 SmpCommandLine_Benchmark.cpp -o smp_benchmark
+//      or: $ cmake -S . -B build && cmake --build build --target run_benchmark
+// Run: $./smp_benchmark [-n max_tokens] [-r repeat] > benchmark.csv
+//
+// Synthetic command lines of 10 .. 1,000,000 tokens (long flags with values, combined short flags
+// like '-xzvf', boolean flags and unflagged arguments) are parsed, and every phase is timed
+// separately: the constructor (also from one command string, and with a std::pmr arena), reset()
+// of a warm parser, each getXxxx family, tryGet<int>(), the parsing of values with units,
+// SmpOptionBinder::parseInto(), the getXxxx( index ) loop, the positionals() pass,
+// showHelpMessage(), checkValidity() suggesting flags for typos (its 'tokens' column counts the
+// registered flags), getRange() and the expansion of its range in 4 partitions, freeze(), lookups
+// in the frozen result from 4 threads, and attaching to its snapshot. A job manifest of the same
+// size is parsed by SmpBatchParser on one thread and on all hardware threads. Heap allocations
+// are counted by replacing the global operator new.
+// Output is CSV (one row per phase and size) on stdout:
+//
+//     phase,tokens,calls,ns_total,ns_per_token,allocations,allocations_per_token
+
+#include "SmpCommandLine.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <thread>
+
+using namespace std;
+
+//-------------------------------------------------------------------------------------------------
+// Interposed allocator: counts every allocation made through operator new.
+
+static std::atomic<unsigned long long> gAllocationCount( 0 );
+
+static void* countedAlloc( size_t size )
+{
+    gAllocationCount.fetch_add( 1, std::memory_order_relaxed );
+    void* p = malloc( size == 0 ? 1 : size );
+    if( p == NULL )
+        throw std::bad_alloc();
+    return( p );
+}
+
+void* operator new( size_t size )                         { return( countedAlloc( size ) ); }
+void* operator new[]( size_t size )                       { return( countedAlloc( size ) ); }
+void* operator new( size_t size, const std::nothrow_t& ) noexcept
+{
+    gAllocationCount.fetch_add( 1, std::memory_order_relaxed );
+    return( malloc( size == 0 ? 1 : size ) );
+}
+void* operator new[]( size_t size, const std::nothrow_t& t ) noexcept { return( operator new( size, t ) ); }
+void  operator delete( void* p ) noexcept                 { free( p ); }
+void  operator delete[]( void* p ) noexcept               { operator delete( p ); }
+void  operator delete( void* p, size_t ) noexcept         { operator delete( p ); }
+void  operator delete[]( void* p, size_t ) noexcept       { operator delete[]( p ); }
+
+// std::pmr::new_delete_resource() allocates through the aligned forms:
+void* operator new( size_t size, std::align_val_t alignment )
+{
+    gAllocationCount.fetch_add( 1, std::memory_order_relaxed );
+    size_t align = std::max( (size_t)alignment, sizeof(void*) );
+    void* p = NULL;
+    if( posix_memalign( &p, align, size == 0 ? 1 : size ) != 0 )
+        throw std::bad_alloc();
+    return( p );
+}
+void* operator new[]( size_t size, std::align_val_t alignment )       { return( operator new( size, alignment ) ); }
+void  operator delete( void* p, std::align_val_t ) noexcept           { free( p ); }
+void  operator delete[]( void* p, std::align_val_t a ) noexcept       { operator delete( p, a ); }
+void  operator delete( void* p, size_t, std::align_val_t ) noexcept   { free( p ); }
+void  operator delete[]( void* p, size_t, std::align_val_t a ) noexcept { operator delete( p, a ); }
+
+//-------------------------------------------------------------------------------------------------
+
+// A synthetic command line, and the flags it contains per getter family.
+struct SyntheticArgv
+{
+    vector<string> storage;
+    vector<char*>  argv;
+    vector<string> intFlags;
+    vector<string> realFlags;
+    vector<string> stringFlags;
+    vector<string> boolFlags;
+    int            positionalCount = 0;
+
+    explicit SyntheticArgv( size_t tokenCount )
+    {
+        storage.reserve( tokenCount + 1 );
+        storage.push_back( "smp_benchmark" );
+
+        // Repeating pattern of 10 tokens: 3 valued long flags, a combined short flag, a boolean
+        // long flag and 2 unflagged arguments.
+        for( size_t i = 0; storage.size() <= tokenCount; i++ )
+        {
+            string n = to_string( i );
+            switch( i % 7 )
+            {
+              case 0:  intFlags.push_back( "int" + n );      push( "--int" + n, tokenCount );    push( n, tokenCount );            break;
+              case 1:  realFlags.push_back( "real" + n );    push( "--real" + n, tokenCount );   push( n + ".5", tokenCount );     break;
+              case 2:  stringFlags.push_back( "name" + n );  push( "--name" + n, tokenCount );   push( "value" + n, tokenCount );  break;
+              case 3:  push( "-xzvf", tokenCount );                                                                               break;
+              case 4:  boolFlags.push_back( "bool" + n );    push( "--bool" + n, tokenCount );                                    break;
+              default: positionalCount += push( "file" + n + ".dat", tokenCount );                                                break;
+            }
+        }
+
+        for( size_t i = 0; i < storage.size(); i++ ) {
+            argv.push_back( &storage[i][0] );
+        }
+        argv.push_back( NULL );
+    };
+
+    int push( const string& token, size_t tokenCount )
+    {
+        if( storage.size() > tokenCount )
+            return( 0 );
+        storage.push_back( token );
+        return( 1 );
+    };
+
+    int argc() const { return( (int)argv.size() - 1 ); };
+};
+
+struct Measurement
+{
+    chrono::steady_clock::time_point start;
+    chrono::steady_clock::time_point end;
+    unsigned long long               allocations;
+    bool                             bStopped;
+
+    Measurement() : start( chrono::steady_clock::now() ), allocations( gAllocationCount.load() ), bStopped( false ) {};
+
+    void stop()
+    {
+        end = chrono::steady_clock::now();
+        allocations = gAllocationCount.load() - allocations;
+        bStopped = true;
+    };
+
+    void report( const char* phase, size_t tokens, size_t calls, int repeat )
+    {
+        if( !bStopped )
+            stop();
+
+        double ns = (double)chrono::duration_cast<chrono::nanoseconds>( end - start ).count() / repeat;
+        double allocs = (double)allocations / repeat;
+
+        printf( "%s,%zu,%zu,%.0f,%.3f,%.0f,%.4f\n", phase, tokens, calls, ns, ns / tokens, allocs, allocs / tokens );
+        fflush( stdout );
+    };
+};
+
+static void runBenchmark( size_t tokenCount, int repeat )
+{
+    SyntheticArgv input( tokenCount );
+    size_t tokens = (size_t)input.argc();
+    size_t calls = 0;
+
+    // Constructor:
+    {
+        Measurement m;
+        for( int r = 0; r < repeat; r++ ) {
+            SmpCommandLine parser( input.argc(), input.argv.data() );
+        }
+        m.report( "constructor", tokens, 1, repeat );
+    }
+
+    // Constructor from the same arguments as one command string:
+    {
+        string commandLine;
+        for( const string& arg : input.storage )  commandLine += arg + ' ';
+
+        Measurement m;
+        for( int r = 0; r < repeat; r++ ) {
+            SmpCommandLine parser( commandLine );
+        }
+        m.report( "constructor_command_string", tokens, 1, repeat );
+    }
+
+    // Constructor, getters and destructor with all parser storage in a monotonic arena (only the
+    // arena's own buffers are counted as allocations then):
+    {
+        Measurement m;
+        for( int r = 0; r < repeat; r++ ) {
+            std::pmr::monotonic_buffer_resource arena( tokens * 64 );
+            SmpCommandLine parser( input.argc(), input.argv.data(), &arena );
+            for( const string& flag : input.intFlags )  calls += parser.getInteger( NULL, flag.c_str(), 0, "an integer" ) >= 0;
+        }
+        m.report( "constructor_getInteger_arena", tokens, input.intFlags.size() + 1, repeat );
+    }
+
+    // reset() of one parser to the same command line, with the getters: after the first rounds
+    // have grown its tables, this does not allocate at all (checked by SmpCommandLine_Test.cpp).
+    {
+        SmpCommandLine parser( 0, NULL );
+        for( int r = 0; r < 2; r++ ) {
+            parser.reset( input.argc(), input.argv.data() );
+            for( const string& flag : input.intFlags )     parser.getInteger( NULL, flag.c_str(), 0, "an integer" );
+            for( const string& flag : input.stringFlags )  parser.getStringView( NULL, flag.c_str(), "", "a string" );
+        }
+
+        Measurement m;
+        for( int r = 0; r < repeat; r++ ) {
+            parser.reset( input.argc(), input.argv.data() );
+            for( const string& flag : input.intFlags )     calls += parser.getInteger( NULL, flag.c_str(), 0, "an integer" ) >= 0;
+            for( const string& flag : input.stringFlags )  calls += parser.getStringView( NULL, flag.c_str(), "", "a string" ).size();
+            for( string_view file : parser.positionals() ) calls += file.size();
+        }
+        m.report( "reset_steady_state", tokens, input.intFlags.size() + input.stringFlags.size() + 1, repeat );
+    }
+
+    // Each getter family, on a fresh parser (constructed outside the measurement):
+    {
+        vector<SmpCommandLine> parsers;
+        parsers.reserve( repeat );
+        for( int r = 0; r < repeat; r++ )  parsers.emplace_back( input.argc(), input.argv.data() );
+
+        Measurement m;
+        for( int r = 0; r < repeat; r++ ) {
+            for( const string& flag : input.intFlags )  calls += parsers[r].getInteger( NULL, flag.c_str(), 0, "an integer" ) >= 0;
+        }
+        m.report( "getInteger", tokens, input.intFlags.size(), repeat );
+    }
+    {
+        vector<SmpCommandLine> parsers;
+        parsers.reserve( repeat );
+        for( int r = 0; r < repeat; r++ )  parsers.emplace_back( input.argc(), input.argv.data() );
+
+        Measurement m;
+        for( int r = 0; r < repeat; r++ ) {
+            for( const string& flag : input.intFlags )  calls += parsers[r].tryGet<int>( NULL, flag.c_str(), 0, "an integer" ).has_value();
+        }
+        m.report( "tryGet_int", tokens, input.intFlags.size(), repeat );
+    }
+    {
+        vector<SmpCommandLine> parsers;
+        parsers.reserve( repeat );
+        for( int r = 0; r < repeat; r++ )  parsers.emplace_back( input.argc(), input.argv.data() );
+
+        Measurement m;
+        for( int r = 0; r < repeat; r++ ) {
+            for( const string& flag : input.realFlags )  calls += parsers[r].getDouble( NULL, flag.c_str(), 0.0, "a real" ) >= 0.0;
+        }
+        m.report( "getDouble", tokens, input.realFlags.size(), repeat );
+    }
+    {
+        vector<SmpCommandLine> parsers;
+        parsers.reserve( repeat );
+        for( int r = 0; r < repeat; r++ )  parsers.emplace_back( input.argc(), input.argv.data() );
+
+        Measurement m;
+        for( int r = 0; r < repeat; r++ ) {
+            for( const string& flag : input.intFlags )  calls += parsers[r].getBytes( NULL, flag.c_str(), 0, "a byte size" ) > 0;
+        }
+        m.report( "getBytes", tokens, input.intFlags.size(), repeat );
+    }
+
+    // SmpUnits::parse() of one suffixed value per token, cycling through durations, byte sizes and
+    // counts:
+    {
+        struct UnitCase { const char* text; const SmpUnit* units; uint64_t expected; };
+        static constexpr UnitCase kCases[] = {
+            { "250ms", SmpUnits::kDuration, 250000000ull },  { "1.5s", SmpUnits::kDuration, 1500000000ull },
+            { "2h", SmpUnits::kDuration, 7200000000000ull }, { "4GiB", SmpUnits::kBytes, 4ull << 30 },
+            { "512k", SmpUnits::kBytes, 512ull << 10 },      { "3MB", SmpUnits::kBytes, 3000000ull },
+            { "10k", SmpUnits::kCount, 10000ull },           { "1.25M", SmpUnits::kCount, 1250000ull } };
+        const size_t kCaseCount = sizeof(kCases) / sizeof(kCases[0]);
+
+        Measurement m;
+        for( int r = 0; r < repeat; r++ ) {
+            for( size_t i = 0; i < tokens; i++ ) 
+            {
+                const UnitCase& c = kCases[ i % kCaseCount ];
+                uint64_t value = 0;
+                SmpUnits::parse( c.text, c.units, value );
+                calls += (size_t)( value == c.expected );
+            }
+        }
+        m.report( "units_parse", tokens, tokens, repeat );
+    }
+    {
+        vector<SmpCommandLine> parsers;
+        parsers.reserve( repeat );
+        for( int r = 0; r < repeat; r++ )  parsers.emplace_back( input.argc(), input.argv.data() );
+
+        Measurement m;
+        for( int r = 0; r < repeat; r++ ) {
+            for( const string& flag : input.stringFlags )  calls += parsers[r].getString( NULL, flag.c_str(), "", "a string" ).size();
+        }
+        m.report( "getString", tokens, input.stringFlags.size(), repeat );
+    }
+    {
+        vector<SmpCommandLine> parsers;
+        parsers.reserve( repeat );
+        for( int r = 0; r < repeat; r++ )  parsers.emplace_back( input.argc(), input.argv.data() );
+
+        Measurement m;
+        for( int r = 0; r < repeat; r++ ) {
+            for( const string& flag : input.boolFlags )  calls += parsers[r].getBoolean( NULL, flag.c_str(), "a boolean" );
+            calls += parsers[r].getBoolean( "x", NULL ) + parsers[r].getBoolean( "z", NULL ) +
+                     parsers[r].getBoolean( "v", NULL ) + parsers[r].getBoolean( "f", NULL );
+        }
+        m.report( "getBoolean", tokens, input.boolFlags.size() + 4, repeat );
+    }
+
+    // SmpOptionBinder::parseInto(): one pass over the whole token table, filling a struct:
+    {
+        struct Config { int64_t first; double firstReal; std::string_view firstName; bool bFirst; };
+
+        SmpOptionBinder<Config> binder;
+        binder.bind( &Config::first,     NULL, input.intFlags[0].c_str(), 0, "an integer" )
+              .bind( &Config::firstReal, NULL, input.realFlags.empty() ? "real" : input.realFlags[0].c_str(), 0.0, "a real" )
+              .bind( &Config::firstName, NULL, input.stringFlags.empty() ? "name" : input.stringFlags[0].c_str(), "", "a string" )
+              .bind( &Config::bFirst,    NULL, input.boolFlags.empty() ? "bool" : input.boolFlags[0].c_str(), false, "a boolean" );
+
+        vector<SmpCommandLine> parsers;
+        parsers.reserve( repeat );
+        for( int r = 0; r < repeat; r++ )  parsers.emplace_back( input.argc(), input.argv.data() );
+
+        Measurement m;
+        for( int r = 0; r < repeat; r++ ) {
+            Config config;
+            calls += binder.parseInto( parsers[r], config );
+        }
+        m.report( "parseInto", tokens, 1, repeat );
+    }
+
+    // Unflagged arguments, after all the flagged ones are extracted:
+    {
+        vector<SmpCommandLine> parsers;
+        parsers.reserve( repeat );
+        for( int r = 0; r < repeat; r++ ) {
+            parsers.emplace_back( input.argc(), input.argv.data() );
+            for( const string& flag : input.intFlags )     parsers[r].getInteger( NULL, flag.c_str() );
+            for( const string& flag : input.realFlags )    parsers[r].getDouble( NULL, flag.c_str() );
+            for( const string& flag : input.stringFlags )  parsers[r].getStringView( NULL, flag.c_str() );
+            for( const string& flag : input.boolFlags )    parsers[r].getBoolean( NULL, flag.c_str() );
+            while( parsers[r].getBoolean( "x", NULL ) || parsers[r].getBoolean( "z", NULL ) ||
+                   parsers[r].getBoolean( "v", NULL ) || parsers[r].getBoolean( "f", NULL ) ) {}
+        }
+
+        Measurement m;
+        for( int r = 0; r < repeat; r++ ) {
+            for( int i = 1; i <= input.positionalCount; i++ )  calls += parsers[r].getStringView( i ).size();
+        }
+        m.report( "getUnflaggedArgument_loop", tokens, input.positionalCount, repeat );
+
+        Measurement p;
+        for( int r = 0; r < repeat; r++ ) {
+            for( std::string_view file : parsers[r].positionals() )  calls += file.size();
+        }
+        p.report( "positionals", tokens, input.positionalCount, repeat );
+
+        // showHelpMessage(), written to /dev/null:
+        fflush( stdout );
+        int savedStdout = dup( fileno( stdout ) );
+        FILE* devNull = freopen( "/dev/null", "w", stdout );
+        Measurement h;
+        for( int r = 0; r < repeat; r++ ) {
+            parsers[r].showHelpMessage();
+        }
+        h.stop();
+
+        fflush( stdout );
+        dup2( savedStdout, fileno( stdout ) );
+        close( savedStdout );
+        (void)devNull;
+        h.report( "showHelpMessage", tokens, 1, repeat );
+    }
+
+    // checkValidity() of 4 mistyped flags, each matched against every registered integer flag
+    // and 'radius' for its suggestion (the diagnostics go to /dev/null):
+    {
+        string typos[] = { "smp_benchmark", "--itn0", "--int", "--innt7", "--raduis" };
+        vector<char*> typoArgv;
+        for( string& typo : typos )  typoArgv.push_back( &typo[0] );
+        typoArgv.push_back( NULL );
+
+        SmpCommandLine parser( (int)typoArgv.size() - 1, typoArgv.data() );
+        for( const string& flag : input.intFlags )  parser.getInteger( NULL, flag.c_str() );
+        parser.getDouble( "r", "radius", 1.0, "the radius of the sphere" );
+
+        fflush( stdout );
+        int savedStdout = dup( fileno( stdout ) );
+        FILE* devNull = freopen( "/dev/null", "w", stdout );
+        Measurement v;
+        for( int r = 0; r < repeat; r++ ) {
+            calls += ( parser.checkValidity() != 0 ) + parser.diagnostics().size();
+        }
+        v.stop();
+
+        fflush( stdout );
+        dup2( savedStdout, fileno( stdout ) );
+        close( savedStdout );
+        (void)devNull;
+        v.report( "checkValidity_4_typos", input.intFlags.size(), 4, repeat );
+    }
+
+    // getRange() of a sweep with as many elements as tokens, then its expansion in 4 partitions:
+    {
+        string sweep = "0:" + to_string( tokens * 4 ) + ":4";
+        string frameArgs[] = { "smp_benchmark", "--frames", sweep };
+        char* frameArgv[] = { &frameArgs[0][0], &frameArgs[1][0], &frameArgs[2][0], NULL };
+
+        vector<SmpCommandLine> parsers;
+        parsers.reserve( repeat );
+        for( int r = 0; r < repeat; r++ )  parsers.emplace_back( 3, frameArgv );
+
+        vector< SmpRange<int64_t> > ranges;
+        ranges.reserve( repeat );
+        Measurement g;
+        for( int r = 0; r < repeat; r++ ) {
+            ranges.push_back( parsers[r].getRange<int64_t>( "f", "frames", "0:1", "frames to render" ) );
+        }
+        g.report( "getRange", 1, 1, repeat );
+
+        const int kParts = 4;
+        Measurement e;
+        for( int r = 0; r < repeat; r++ ) {
+            for( int k = 0; k < kParts; k++ ) {
+                for( int64_t frame : ranges[r].partition( kParts, k ) )  calls += (size_t)frame;
+            }
+        }
+        e.report( "range_partition4", tokens, kParts, repeat );
+    }
+
+    // freeze(), then the frozen SmpParsedArgs read by 4 threads at once:
+    {
+        vector<SmpCommandLine> parsers;
+        parsers.reserve( repeat );
+        for( int r = 0; r < repeat; r++ ) {
+            parsers.emplace_back( input.argc(), input.argv.data() );
+            for( const string& flag : input.intFlags )  parsers[r].getInteger( NULL, flag.c_str() );
+        }
+
+        vector<SmpParsedArgs> frozen;
+        Measurement f;
+        for( int r = 0; r < repeat; r++ ) {
+            frozen.push_back( parsers[r].freeze() );
+        }
+        f.report( "freeze", tokens, 1, repeat );
+
+        const int kThreads = 4;
+        std::atomic<size_t> found( 0 );
+        Measurement t;
+        for( int r = 0; r < repeat; r++ ) 
+        {
+            vector<thread> readers;
+            for( int k = 0; k < kThreads; k++ ) {
+                readers.emplace_back( [&input, &frozen, &found, r]() {
+                    size_t local = 0;
+                    for( const string& flag : input.intFlags )  local += frozen[r].has( flag.c_str() );
+                    found += local;
+                } );
+            }
+            for( thread& reader : readers )  reader.join();
+        }
+        t.report( "frozen_lookup_4threads", tokens, input.intFlags.size() * kThreads, repeat );
+        calls += found;
+
+        // A child process attaching to the frozen result instead of parsing argv again:
+        int fd = frozen[0].writeSnapshot();
+        Measurement a;
+        for( int r = 0; r < repeat; r++ ) {
+            SmpParsedArgs attached = SmpParsedArgs::fromSnapshot( fd );
+            for( const string& flag : input.intFlags )  calls += attached.getInteger( flag.c_str() ) >= 0;
+        }
+        a.report( "snapshot_attach_getInteger", tokens, input.intFlags.size() + 1, repeat );
+        close( fd );
+    }
+
+    if( calls == 0 )
+        fprintf( stderr, "(no values extracted)\n" );
+}
+
+// A job manifest of 8-token lines, parsed by SmpBatchParser on 1 thread and on all of them:
+static constexpr SmpOption kManifestOptions[] = {
+    { "i", "index",   kSmpInteger, "0",     "an integer" },
+    { "r", "radius",  kSmpReal,    "1.0",   "a real" },
+    { "n", "name",    kSmpString,  "",      "a string" },
+    { "v", "verbose", kSmpBoolean, "false", "a boolean" },
+};
+static constexpr SmpOptionSchema<4> kManifestSchema( kManifestOptions );
+
+static void runBatchBenchmark( size_t tokenCount, int repeat )
+{
+    string manifest;
+    size_t lines = std::max( tokenCount / 8, (size_t)1 );
+    for( size_t i = 0; i < lines; i++ ) {
+        manifest += "task --index " + to_string( i ) + " -r " + to_string( i ) + ".5 -vn 'job " + to_string( i ) + "' out.dat\n";
+    }
+
+    unsigned hardwareThreads = std::max( std::thread::hardware_concurrency(), 1u );
+    string text;
+    size_t calls = 0;
+
+    for( int pass = 0; pass < 2; pass++ ) 
+    {
+        SmpBatchParser<4> parser( kManifestSchema, pass == 0 ? 1 : hardwareThreads );
+        Measurement m;
+        for( int r = 0; r < repeat; r++ ) {
+            text = manifest;  // unquoted in place
+            calls += parser.parse( &text[0], text.size() ).lineCount();
+        }
+        m.report( pass == 0 ? "batch_manifest_1thread" : "batch_manifest_all_threads", lines * 8, lines, repeat );
+    }
+
+    if( calls == 0 )
+        fprintf( stderr, "(no manifest lines parsed)\n" );
+}
+
+int main( int argc, char *argv[] )
+{
+    SmpCommandLine userCommands( argc, argv );
+
+    size_t maxTokens = userCommands.getSize( "n", "max_tokens", 1000000, "largest synthetic command line, in tokens" );
+    int    repeat    = userCommands.getInteger( "r", "repeat", 3, "repetitions per measurement" );
+
+    if( userCommands.helpMessageWanted() ) {
+        userCommands.showHelpMessage();
+        return( 0 );
+    }
+    repeat = std::max( repeat, 1 );
+
+    printf( "phase,tokens,calls,ns_total,ns_per_token,allocations,allocations_per_token\n" );
+
+    for( size_t tokens = 10; tokens <= maxTokens; tokens *= 10 )
+    {
+        runBenchmark( tokens, tokens >= 100000 ? 1 : repeat );
+        runBatchBenchmark( tokens, tokens >= 100000 ? 1 : repeat );
+    }
+
+return(0);
+}
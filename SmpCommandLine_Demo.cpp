@@ -5,6 +5,7 @@
 // Run: $./my_program ...
 
 #include "SmpCommandLine.hpp"  
+#include <iostream>
 
 using namespace std;
 
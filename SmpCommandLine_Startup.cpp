@@ -0,0 +1,127 @@
+// SmpCommandLine_Startup.cpp
+// Startup-latency benchmark of SmpCommandLine.hpp
+// Compile: $ g++ -O2 -std=c++17 SmpCommandLine_Startup.cpp -o smp_startup
+//          $ g++ -O2 -std=c++17 -DSMP_LOW_STARTUP SmpCommandLine_Startup.cpp -o smp_startup_low
+//      or: $ cmake -S . -B build && cmake --build build --target run_startup_benchmark
+// Run: $./smp_startup -s 2000 ./smp_startup ./smp_startup_low > startup.csv
+//
+// Without -s, this is a tiny helper program: it parses a typical command line of a few flags and
+// exits, with the number of heap allocations made by SmpCommandLine as exit status. With -s N, it
+// starts each helper program given as argument N times (after a few warm-up runs) and reports the
+// mean wall time from posix_spawn() to the helper's exit, as CSV on stdout:
+//
+//     program,runs,us_per_run,allocations
+
+#include "SmpCommandLine.hpp"
+
+#include <chrono>
+#include <new>
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char** environ;
+
+//-------------------------------------------------------------------------------------------------
+// Interposed allocator: counts every allocation made through operator new.
+
+static unsigned long gAllocationCount = 0;
+
+static void* countedAlloc( size_t size )
+{
+    gAllocationCount++;
+    void* p = malloc( size == 0 ? 1 : size );
+    if( p == NULL )
+        throw std::bad_alloc();
+    return( p );
+}
+
+void* operator new( size_t size )                   { return( countedAlloc( size ) ); }
+
+void* operator new( size_t size, std::align_val_t alignment )
+{
+    gAllocationCount++;
+    size_t a = (size_t)alignment;
+    void* p = aligned_alloc( a, ( size + a - 1 ) / a * a );
+    if( p == NULL )
+        throw std::bad_alloc();
+    return( p );
+}
+
+void* operator new[]( size_t size )                 { return( countedAlloc( size ) ); }
+void* operator new[]( size_t size, std::align_val_t alignment ) { return( operator new( size, alignment ) ); }
+void  operator delete( void* p ) noexcept           { free( p ); }
+void  operator delete[]( void* p ) noexcept         { operator delete( p ); }
+void  operator delete( void* p, size_t ) noexcept   { free( p ); }
+void  operator delete[]( void* p, size_t ) noexcept { operator delete( p ); }
+void  operator delete( void* p, std::align_val_t ) noexcept           { free( p ); }
+void  operator delete[]( void* p, std::align_val_t a ) noexcept       { operator delete( p, a ); }
+void  operator delete( void* p, size_t, std::align_val_t ) noexcept   { free( p ); }
+void  operator delete[]( void* p, size_t, std::align_val_t a ) noexcept { operator delete( p, a ); }
+
+//-------------------------------------------------------------------------------------------------
+
+// Runs 'program' with the helper's command line; returns its exit status, -1 if it failed.
+static int spawnHelper( const char* program )
+{
+    const char* const argv[] = { program, "-i", "42", "--radius", "2.5", "-v", "--name", "job", "in.dat", "out.dat", NULL };
+
+    pid_t pid;
+    if( posix_spawn( &pid, program, NULL, NULL, (char* const*)argv, environ ) != 0 )
+        return( -1 );
+
+    int status = 0;
+    if( waitpid( pid, &status, 0 ) != pid || !WIFEXITED( status ) )
+        return( -1 );
+    return( WEXITSTATUS( status ) );
+}
+
+static int runBenchmark( SmpCommandLine& userCommands, int runs )
+{
+    printf( "program,runs,us_per_run,allocations\n" );
+
+    for( std::string_view program : userCommands.positionals() )
+    {
+        std::string path( program );
+        int allocations = -1;
+        for( int r = 0; r < 10; r++ ) {
+            allocations = spawnHelper( path.c_str() );
+        }
+        if( allocations < 0 ) {
+            fprintf( stderr, "%s can not be run.\n", path.c_str() );
+            return( 1 );
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for( int r = 0; r < runs; r++ ) {
+            spawnHelper( path.c_str() );
+        }
+        double us = std::chrono::duration<double, std::micro>( std::chrono::steady_clock::now() - start ).count() / runs;
+
+        printf( "%s,%d,%.1f,%d\n", path.c_str(), runs, us, allocations );
+        fflush( stdout );
+    }
+    return( 0 );
+}
+
+int main( int argc, char *argv[] )
+{
+    unsigned long allocations = gAllocationCount;
+    SmpCommandLine userCommands( argc, argv );
+
+    int         runs     = userCommands.getInteger( "s", "spawn", 0, "benchmark: runs per helper program given as argument" );
+    int         index    = userCommands.getInteger( "i", "index", 0, "the index of the item" );
+    double      radius   = userCommands.getDouble( "r", "radius", 1.0, "the radius of the sphere" );
+    bool        bVerbose = userCommands.getBoolean( "v", "verbose", "report progress" );
+    std::string_view name = userCommands.getStringView( "n", "name", "", "name of the job" );
+    std::string_view input  = userCommands.getStringView( 1, "", "input file" );
+    std::string_view output = userCommands.getStringView( 2, "", "output file" );
+    allocations = gAllocationCount - allocations;
+
+    if( runs > 0 )
+        return( runBenchmark( userCommands, runs ) );
+
+    // The helper does no work: its arguments only have to be used.
+    if( index < 0 || radius < 0 || ( bVerbose && name.size() + input.size() + output.size() == 0 ) )
+        return( 255 );
+    return( (int)std::min( allocations, 254ul ) );
+}
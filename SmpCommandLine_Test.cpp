@@ -0,0 +1,452 @@
+// SmpCommandLine_Test.cpp
+// Correctness checks of SmpCommandLine.hpp (the benchmarks only measure time and allocations)
+// Compile: $ g++ -O2 -std=c++17 SmpCommandLine_Test.cpp -o smp_test -lpthread
+//      or: $ cmake -S . -B build && cmake --build build && ctest --test-dir build
+// Run: $./smp_test
+//
+// Every failed check is reported on stderr with its line; the program fails if any did.
+
+#include "SmpCommandLine.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <thread>
+
+using namespace std;
+
+//-------------------------------------------------------------------------------------------------
+// Interposed allocator: counts every allocation made through operator new, for the checks of
+// code that must not allocate.
+
+static atomic<unsigned long> gAllocationCount( 0 );
+
+static void* countedAlloc( size_t size )
+{
+    gAllocationCount.fetch_add( 1, memory_order_relaxed );
+    void* p = malloc( size == 0 ? 1 : size );
+    if( p == NULL )
+        throw bad_alloc();
+    return( p );
+}
+
+void* operator new( size_t size )                   { return( countedAlloc( size ) ); }
+void* operator new[]( size_t size )                 { return( countedAlloc( size ) ); }
+void* operator new( size_t size, const nothrow_t& ) noexcept
+{
+    gAllocationCount.fetch_add( 1, memory_order_relaxed );
+    return( malloc( size == 0 ? 1 : size ) );
+}
+void* operator new[]( size_t size, const nothrow_t& t ) noexcept { return( operator new( size, t ) ); }
+void  operator delete( void* p ) noexcept           { free( p ); }
+void  operator delete[]( void* p ) noexcept         { operator delete( p ); }
+void  operator delete( void* p, size_t ) noexcept   { operator delete( p ); }
+void  operator delete[]( void* p, size_t ) noexcept { operator delete( p ); }
+
+// std::pmr::new_delete_resource() allocates through the aligned forms:
+void* operator new( size_t size, align_val_t alignment )
+{
+    gAllocationCount.fetch_add( 1, memory_order_relaxed );
+    void* p = NULL;
+    if( posix_memalign( &p, max( (size_t)alignment, sizeof(void*) ), size == 0 ? 1 : size ) != 0 )
+        throw bad_alloc();
+    return( p );
+}
+void* operator new[]( size_t size, align_val_t alignment )       { return( operator new( size, alignment ) ); }
+void  operator delete( void* p, align_val_t ) noexcept           { free( p ); }
+void  operator delete[]( void* p, align_val_t a ) noexcept       { operator delete( p, a ); }
+void  operator delete( void* p, size_t, align_val_t a ) noexcept { operator delete( p, a ); }
+void  operator delete[]( void* p, size_t, align_val_t a ) noexcept { operator delete( p, a ); }
+
+//-------------------------------------------------------------------------------------------------
+
+static int gFailures = 0;
+
+#define SMP_CHECK( condition )  checkThat( ( condition ), #condition, __LINE__ )
+
+static void checkThat( bool bPassed, const char* condition, int line )
+{
+    if( !bPassed ) {
+        fprintf( stderr, "SmpCommandLine_Test.cpp:%d: check failed: %s\n", line, condition );
+        gFailures++;
+    }
+}
+
+// A writable argv, as main() gets it.
+struct TestArgv
+{
+    vector<string> storage;
+    vector<char*>  argv;
+
+    TestArgv( initializer_list<const char*> args ) : storage( args.begin(), args.end() )
+    {
+        for( string& arg : storage )  argv.push_back( &arg[0] );
+        argv.push_back( NULL );
+    };
+
+    int argc() const { return( (int)argv.size() - 1 ); };
+    char** data() { return( argv.data() ); };
+};
+
+//-------------------------------------------------------------------------------------------------
+
+// freeze(): the frozen result answers like the parser, under every spelling of a flag and from
+// several threads at once.
+static void testFreeze()
+{
+    TestArgv args = { "prog", "-i", "42", "--radius", "2.5", "-v", "--name", "job", "in.dat", "out.dat" };
+    SmpCommandLine userCommands( args.argc(), args.data() );
+    userCommands.getInteger( "i", "index", 0, "the index" );
+    userCommands.getDouble( "r", "radius", 1.0, "the radius" );
+    userCommands.getBoolean( "v", "verbose", "be verbose" );
+    userCommands.getStringView( "n", "name", "", "the name" );
+    userCommands.getStringView( "d", "dir", "/tmp", "the directory" );
+    userCommands.getStringView( 1, "", "input file" );
+    userCommands.getStringView( 2, "", "output file" );
+
+    SmpParsedArgs frozen = userCommands.freeze();
+    SMP_CHECK( frozen.valid() );
+    SMP_CHECK( frozen.getInteger( "index" ) == 42 );
+    SMP_CHECK( frozen.getInteger( "i" ) == 42 && frozen.getInteger( "--index" ) == 42 && frozen.getInteger( "-i" ) == 42 );
+    SMP_CHECK( frozen.getDouble( "radius" ) == 2.5 );
+    SMP_CHECK( frozen.getBoolean( "verbose" ) );
+    SMP_CHECK( frozen.getString( "name" ) == "job" );
+    SMP_CHECK( !frozen.has( "dir" ) && frozen.getString( "dir" ) == "/tmp" );
+    SMP_CHECK( !frozen.has( "missing" ) && frozen.getInteger( "missing", 7 ) == 7 );
+    SMP_CHECK( frozen.positionalCount() == 2 && frozen.getString( 1 ) == "in.dat" && frozen.getString( 2 ) == "out.dat" );
+    SMP_CHECK( frozen.programName() == "prog" );
+
+    atomic<int> wrong( 0 );
+    vector<thread> readers;
+    for( int k = 0; k < 4; k++ ) {
+        readers.emplace_back( [&frozen, &wrong]() {
+            for( int r = 0; r < 1000; r++ ) {
+                wrong += ( frozen.getInteger( "index" ) != 42 || frozen.getString( "name" ) != "job" );
+            }
+        } );
+    }
+    for( thread& reader : readers )  reader.join();
+    SMP_CHECK( wrong == 0 );
+}
+
+// Snapshots: attached through a memfd and from memory, and buffers that are no valid snapshot
+// (wrong magic, cut short, or a hash table without an empty slot, where a lookup could loop)
+// rejected.
+struct SnapshotLayout : public SmpParsedArgs
+{
+    using SmpParsedArgs::Header;
+};
+
+static void testSnapshot()
+{
+    TestArgv args = { "prog", "--index", "3", "--name", "job", "in.dat" };
+    SmpCommandLine userCommands( args.argc(), args.data() );
+    userCommands.getInteger( "i", "index", 0, "the index" );
+    userCommands.getStringView( "n", "name", "", "the name" );
+    userCommands.getStringView( 1, "", "input file" );
+    SmpParsedArgs frozen = userCommands.freeze();
+
+    int fd = frozen.writeSnapshot();
+    SMP_CHECK( fd >= 0 );
+    SmpParsedArgs attached = SmpParsedArgs::fromSnapshot( fd );
+    close( fd );
+    SMP_CHECK( attached.valid() && attached.getInteger( "index" ) == 3 && attached.getString( "name" ) == "job" );
+    SMP_CHECK( attached.getString( 1 ) == "in.dat" && attached.programName() == "prog" );
+
+    vector<uint64_t> copy( frozen.size() / sizeof(uint64_t) + 1 );
+    memcpy( copy.data(), frozen.data(), frozen.size() );
+    SmpParsedArgs inMemory = SmpParsedArgs::fromSnapshot( copy.data(), frozen.size() );
+    SMP_CHECK( inMemory.valid() && inMemory.getInteger( "i" ) == 3 );
+
+    SMP_CHECK( !SmpParsedArgs::fromSnapshot( copy.data(), frozen.size() / 2 ).valid() );
+
+    SnapshotLayout::Header* header = (SnapshotLayout::Header*)copy.data();
+    uint32_t* slots = (uint32_t*)( (char*)copy.data() + header->slotsOffset );
+    for( uint32_t k = 0; k < header->slotCount; k++ )  slots[k] = 1;
+    SMP_CHECK( !SmpParsedArgs::fromSnapshot( copy.data(), frozen.size() ).valid() );
+
+    header->magic = 0;
+    SMP_CHECK( !SmpParsedArgs::fromSnapshot( copy.data(), frozen.size() ).valid() );
+}
+
+// reset(): once the first rounds have grown the parser's tables, reparsing the same command line
+// with the getters allocates nothing.
+static void testResetSteadyState()
+{
+    TestArgv args = { "prog", "--index", "3", "--radius", "2.5", "-xzvf", "--name", "job", "in.dat", "out.dat" };
+    SmpCommandLine parser( 0, NULL );
+
+    unsigned long allocations = 0;
+    bool bValues = true;
+    for( int r = 0; r < 5; r++ ) 
+    {
+        if( r == 2 )
+            allocations = gAllocationCount.load();
+        parser.reset( args.argc(), args.data() );
+        bValues = bValues && parser.getInteger( "i", "index", 0, "the index" ) == 3;
+        bValues = bValues && parser.getDouble( "r", "radius", 1.0, "the radius" ) == 2.5;
+        bValues = bValues && parser.getBoolean( "z", NULL, "compress" );
+        bValues = bValues && parser.getStringView( "n", "name", "", "the name" ) == "job";
+        int files = 0;
+        for( string_view file : parser.positionals() )  files += ( file == "in.dat" || file == "out.dat" );
+        bValues = bValues && files == 2;
+    }
+    SMP_CHECK( bValues );
+    SMP_CHECK( gAllocationCount.load() == allocations );
+}
+
+// checkValidity(): one diagnostic per mistyped flag, at its position, suggesting the intended
+// flag. 'itn0' is too far from 'int0' for its length; '--int' is as near to 'int0' as to 'int7',
+// and the first registered wins.
+static void testTypoSuggestions()
+{
+    TestArgv args = { "prog", "--itn0", "--int", "--innt7", "--raduis" };
+    SmpCommandLine userCommands( args.argc(), args.data() );
+    userCommands.getInteger( NULL, "int0", 0, "an integer" );
+    userCommands.getInteger( NULL, "int7", 0, "an integer" );
+    userCommands.getDouble( "r", "radius", 1.0, "the radius" );
+    SMP_CHECK( userCommands.checkValidity( false ) == -1 );
+
+    const pmr::vector<SmpDiagnostic>& found = userCommands.diagnostics();
+    SMP_CHECK( found.size() == 4 );
+    for( size_t i = 0; i < found.size() && i < 4; i++ ) {
+        SMP_CHECK( found[i].kind == kSmpUnknownFlag && found[i].position == (int)i + 1 && found[i].text == args.storage[i + 1] );
+    }
+    if( found.size() == 4 ) {
+        SMP_CHECK( found[0].suggestion.empty() );
+        SMP_CHECK( found[1].suggestion == "int0" && found[1].suggestionHyphens == 2 );
+        SMP_CHECK( found[2].suggestion == "int7" );
+        SMP_CHECK( found[3].suggestion == "radius" );
+    }
+}
+
+// tryGet(): a value that is no integer comes back as the error (not as the default), a flag
+// without its value and a usage error too; nothing is printed and nothing exits.
+static void testTryGet()
+{
+    TestArgv args = { "prog", "--width", "abc", "--height", "7", "--depth" };
+    SmpCommandLine userCommands( args.argc(), args.data() );
+
+    SmpResult<int> width = userCommands.tryGet<int>( "w", "width", 640, "the width" );
+    SMP_CHECK( !width.has_value() );
+    if( !width.has_value() ) {
+        SMP_CHECK( width.error().kind == kSmpInvalidValue && width.error().convertError == kSmpConvertInvalid );
+        SMP_CHECK( width.error().position == 1 && width.error().text == "abc" && width.error().flag == "--width" );
+    }
+
+    SmpResult<int> height = userCommands.tryGet<int>( "h", "height", 480, "the height" );
+    SMP_CHECK( height.has_value() && *height == 7 );
+
+    SmpResult<int> scale = userCommands.tryGet<int>( "s", "scale", 2, "the scale" );
+    SMP_CHECK( scale.has_value() && *scale == 2 );
+
+    SmpResult<int> depth = userCommands.tryGet<int>( "d", "depth", 8, "the depth" );
+    SMP_CHECK( !depth.has_value() && depth.error().kind == kSmpMissingValue && depth.error().position == 5 );
+
+    SmpResult<int> unnamed = userCommands.tryGet<int>( NULL, NULL, 1, "no flag at all" );
+    SMP_CHECK( !unnamed.has_value() && unnamed.error().kind == kSmpUsageError );
+
+    SMP_CHECK( userCommands.diagnostics().size() == 3 );
+}
+
+// SmpRange: the three forms, empty and invalid ranges, and partitions that together hold every
+// element once, in order, without allocating.
+static void testRange()
+{
+    SmpRange<int64_t> range;
+    SMP_CHECK( SmpRange<int64_t>::parse( "0:10:3", range ).error == kSmpConvertOk );
+    SMP_CHECK( range.size() == 4 && range[0] == 0 && range[1] == 3 && range.back() == 9 );
+    SMP_CHECK( SmpRange<int64_t>::parse( "10:0:-4", range ).error == kSmpConvertOk );
+    SMP_CHECK( range.size() == 3 && range.front() == 10 && range.back() == 2 );
+    SMP_CHECK( SmpRange<int64_t>::parse( "-3-2", range ).error == kSmpConvertOk );
+    SMP_CHECK( range.size() == 6 && range.front() == -3 && range.back() == 2 );
+    SMP_CHECK( SmpRange<int64_t>::parse( "0x10", range ).error == kSmpConvertOk );
+    SMP_CHECK( range.size() == 1 && range.front() == 16 );
+    SMP_CHECK( SmpRange<int64_t>::parse( "5:5", range ).error == kSmpConvertOk && range.empty() );
+
+    SmpRange<int64_t> unchanged = range;
+    SMP_CHECK( SmpRange<int64_t>::parse( "0:10:0", range ).error == kSmpConvertInvalid );
+    SMP_CHECK( SmpRange<int64_t>::parse( "1:x", range ).error == kSmpConvertInvalid );
+    SMP_CHECK( range.size() == unchanged.size() );
+    SmpRange<int8_t> small;
+    SMP_CHECK( SmpRange<int8_t>::parse( "0:300", small ).error == kSmpConvertOutOfRange );
+
+    TestArgv args = { "prog", "--frames", "0:4003:4" };
+    SmpCommandLine userCommands( args.argc(), args.data() );
+    SmpRange<int64_t> frames = userCommands.getRange<int64_t>( "f", "frames", "0:1", "frames to render" );
+    SmpRange<int64_t> seeds = userCommands.getRange<int64_t>( "s", "seeds", "1-3", "seeds" );
+    SMP_CHECK( frames.size() == 1001 && seeds.size() == 3 && seeds.back() == 3 );
+
+    unsigned long allocations = gAllocationCount.load();
+    int64_t expected = 0;
+    bool bInOrder = true;
+    for( int k = 0; k < 4; k++ ) 
+    {
+        SmpRange<int64_t> part = frames.partition( 4, k );
+        bInOrder = bInOrder && part.size() == ( k == 0 ? 251u : 250u );
+        for( int64_t frame : part ) {
+            bInOrder = bInOrder && ( frame == expected );
+            expected += 4;
+        }
+    }
+    SMP_CHECK( bInOrder && expected == 4004 );
+    SMP_CHECK( frames.partition( 4, 4 ).empty() );
+    SMP_CHECK( gAllocationCount.load() == allocations );
+}
+
+// Values with units: SmpUnits::parse() with each table, rejected suffixes and overflow, format()
+// in the largest exact unit, and the getters.
+static void testUnits()
+{
+    struct UnitCase { const char* text; const SmpUnit* units; uint64_t expected; };
+    static constexpr UnitCase kCases[] = {
+        { "250ms", SmpUnits::kDuration, 250000000ull },  { "1.5s", SmpUnits::kDuration, 1500000000ull },
+        { "2h", SmpUnits::kDuration, 7200000000000ull }, { "4GiB", SmpUnits::kBytes, 4ull << 30 },
+        { "512k", SmpUnits::kBytes, 512ull << 10 },      { "3MB", SmpUnits::kBytes, 3000000ull },
+        { "10k", SmpUnits::kCount, 10000ull },           { "1.25M", SmpUnits::kCount, 1250000ull },
+        { "42", SmpUnits::kCount, 42ull },               { ".5KiB", SmpUnits::kBytes, 512ull } };
+
+    for( const UnitCase& c : kCases ) 
+    {
+        uint64_t value = 0;
+        SmpConvertResult result = SmpUnits::parse( c.text, c.units, value );
+        if( result.error != kSmpConvertOk || value != c.expected )
+            fprintf( stderr, "SmpUnits::parse( \"%s\" ): error %d, value %llu\n", c.text, (int)result.error, (unsigned long long)value );
+        SMP_CHECK( result.error == kSmpConvertOk && value == c.expected );
+    }
+
+    uint64_t value = 7;
+    SMP_CHECK( SmpUnits::parse( "10parsecs", SmpUnits::kDuration, value ).error == kSmpConvertInvalid && value == 7 );
+    SMP_CHECK( SmpUnits::parse( "ms", SmpUnits::kDuration, value ).error == kSmpConvertInvalid );
+    SMP_CHECK( SmpUnits::parse( "", SmpUnits::kDuration, value ).error == kSmpConvertEmpty );
+    SMP_CHECK( SmpUnits::parse( "20EiB", SmpUnits::kBytes, value ).error == kSmpConvertOutOfRange );
+    SMP_CHECK( SmpUnits::parse( "1d", SmpUnits::kBytes, value ).error == kSmpConvertInvalid );
+
+    // A fraction has to come to whole base units:
+    SMP_CHECK( SmpUnits::parse( "1.5B", SmpUnits::kBytes, value ).error == kSmpConvertInvalid && value == 7 );
+    SMP_CHECK( SmpUnits::parse( "0.5ns", SmpUnits::kDuration, value ).error == kSmpConvertInvalid );
+    SMP_CHECK( SmpUnits::parse( "2.5", SmpUnits::kCount, value ).error == kSmpConvertInvalid );
+    SMP_CHECK( SmpUnits::parse( "1.0000000001s", SmpUnits::kDuration, value ).error == kSmpConvertInvalid );
+    SMP_CHECK( SmpUnits::parse( "1.0000000000s", SmpUnits::kDuration, value ).error == kSmpConvertOk && value == 1000000000ull );
+    SMP_CHECK( SmpUnits::parse( "0.001KB", SmpUnits::kBytes, value ).error == kSmpConvertOk && value == 1 );
+    SMP_CHECK( SmpUnits::parse( "1.50us", SmpUnits::kDuration, value ).error == kSmpConvertOk && value == 1500 );
+    SMP_CHECK( SmpUnits::parse( "0.000000001s", SmpUnits::kDuration, value ).error == kSmpConvertOk && value == 1 );
+
+    char text[32];
+    SmpUnits::format( 4ull << 30, SmpUnits::kBytes, text, sizeof(text) );
+    SMP_CHECK( string_view( text ) == "4GiB" );
+    SmpUnits::format( 250000000ull, SmpUnits::kDuration, text, sizeof(text) );
+    SMP_CHECK( string_view( text ) == "250ms" );
+    SmpUnits::format( 0, SmpUnits::kCount, text, sizeof(text) );
+    SMP_CHECK( string_view( text ) == "0" );
+
+    TestArgv args = { "prog", "--timeout", "1.5s", "--cache", "512M", "--rate", "2.5k", "3h" };
+    SmpCommandLine userCommands( args.argc(), args.data() );
+    SMP_CHECK( userCommands.getDuration( "t", "timeout", chrono::milliseconds( 250 ), "timeout" ) == chrono::milliseconds( 1500 ) );
+    SMP_CHECK( userCommands.getBytes( "c", "cache", 4ull << 30, "cache size" ) == 512ull << 20 );
+    SMP_CHECK( userCommands.getCount( "r", "rate", 10000, "rate" ) == 2500 );
+    SMP_CHECK( userCommands.getCount( "b", "burst", 64, "burst" ) == 64 );
+    SMP_CHECK( userCommands.getDuration( 1, chrono::seconds( 1 ), "period" ) == chrono::hours( 3 ) );
+}
+
+// reset() after loadConfigFile(): the config file stays loaded (and mapped), so its values are
+// still found for the next command lines.
+static void testResetKeepsConfigFile()
+{
+    char path[] = "/tmp/smp_test_XXXXXX";
+    int fd = mkstemp( path );
+    SMP_CHECK( fd >= 0 );
+    if( fd < 0 )
+        return;
+    const char kConfig[] = "radius = 2.5\n[db]\nhost = db.local\n";
+    SMP_CHECK( write( fd, kConfig, sizeof(kConfig) - 1 ) == (ssize_t)sizeof(kConfig) - 1 );
+    close( fd );
+
+    TestArgv args = { "prog", "--index", "1" };
+    TestArgv next = { "prog", "--index", "2", "--radius", "4" };
+    SmpCommandLine parser( args.argc(), args.data() );
+    SMP_CHECK( parser.loadConfigFile( path ) );
+    SMP_CHECK( parser.getDouble( "r", "radius", 1.0, "the radius" ) == 2.5 );
+
+    for( int r = 0; r < 3; r++ ) 
+    {
+        parser.reset( args.argc(), args.data() );
+        SMP_CHECK( parser.getInteger( "i", "index", 0, "the index" ) == 1 );
+        SMP_CHECK( parser.getDouble( "r", "radius", 1.0, "the radius" ) == 2.5 );
+        SMP_CHECK( parser.getStringView( NULL, "db.host", "", "the database host" ) == "db.local" );
+
+        parser.reset( next.argc(), next.argv.data() );
+        SMP_CHECK( parser.getDouble( "r", "radius", 1.0, "the radius" ) == 4.0 );
+    }
+
+    parser.reset( "prog --index 3" );
+    SMP_CHECK( parser.getDouble( "r", "radius", 1.0, "the radius" ) == 2.5 );
+    unlink( path );
+}
+
+// SmpPerfectHash: over sets of random names, every name is found at its index, unknown names
+// are not, and each name takes exactly one slot of the table.
+template< size_t N >
+struct PerfectHashLayout : public SmpPerfectHash<N>
+{
+    using SmpPerfectHash<N>::SmpPerfectHash;
+
+    size_t occupiedSlots() const
+    {
+        size_t occupied = 0;
+        for( uint16_t slot : this->mSlots )  occupied += ( slot != 0 );
+        return( occupied );
+    };
+};
+
+template< size_t N >
+static void checkPerfectHash( uint64_t& random, int sets )
+{
+    for( int set = 0; set < sets; set++ ) 
+    {
+        array<string, N> storage;
+        array<string_view, N> names;
+        for( size_t i = 0; i < N; i++ ) 
+        {
+            random = random * 6364136223846793005ull + 1442695040888963407ull;
+            storage[i] = "flag" + to_string( i ) + "_" + to_string( random >> 40 );
+            names[i] = storage[i];
+        }
+
+        PerfectHashLayout<N> hash( names );
+        bool bFound = true;
+        for( size_t i = 0; i < N; i++ )  bFound = bFound && hash.find( names[i] ) == (int)i;
+        SMP_CHECK( bFound );
+        SMP_CHECK( hash.find( "no_such_flag" ) == -1 );
+        SMP_CHECK( hash.occupiedSlots() == N );
+    }
+}
+
+static void testPerfectHash()
+{
+    uint64_t random = 2021;
+    checkPerfectHash<8>( random, 500 );
+    checkPerfectHash<32>( random, 500 );
+}
+
+//-------------------------------------------------------------------------------------------------
+
+int main()
+{
+    testFreeze();
+    testSnapshot();
+    testResetSteadyState();
+    testResetKeepsConfigFile();
+    testTypoSuggestions();
+    testTryGet();
+    testRange();
+    testUnits();
+    testPerfectHash();
+
+    if( gFailures > 0 ) {
+        fprintf( stderr, "%d checks failed.\n", gFailures );
+        return( 1 );
+    }
+    printf( "All checks passed.\n" );
+    return( 0 );
+}